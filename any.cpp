@@ -1,7 +1,26 @@
 ﻿#include "any.h"
 #include "variant.h"
+#include "atomic_variant.h"
+#include "box.h"
+#include "erased.h"
+#include "inplace_string.h"
+#include "inplace_vector.h"
+#include "parallel.h"
+#include "poly.h"
+#include "serialize.h"
+#include "signal_slot.h"
+#include "task_queue.h"
+#include "thread_pool.h"
+#include "timer_wheel.h"
+#include "variant_column.h"
+#include "variant_span.h"
+#include <atomic>
+#include <cstdio>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 class B
 {
 public:
@@ -219,6 +238,29 @@ void test_any(void)
         std::cout << a(5) << std::endl;
         std::cout << b(5) << std::endl;
     }
+    {
+        std::unique_ptr<int> p{new int(7)};
+        auto                 lam = [p = lib::move(p)](int n) { return (*p + n); };
+        using F                  = lib::fitted_any<decltype(lam)>::unique_invoker_type<int(int)>;
+        F a{lib::move(lam)};
+        std::cout << a(5) << std::endl;
+        F b{lib::move(a)};
+        std::cout << std::boolalpha << static_cast<bool>(a) << std::endl;
+        std::cout << b(5) << std::endl;
+        a = [](int n) { return n; };
+        lib::swap(a, b);
+        std::cout << a(5) << std::endl;
+        std::cout << b(5) << std::endl;
+    }
+    {
+        int                          m   = 3;
+        auto                         lam = [&m](int n) { return (n * m++); };
+        lib::function_ref<int(int)>  a{lam};
+        lib::function_ref<void(void)> b{func};
+        std::cout << a(5) << std::endl;
+        std::cout << a(5) << std::endl;
+        b();
+    }
 }
 using lib::variant;
 
@@ -337,10 +379,434 @@ void test_variant(void)
 
 
 }
+void test_trace(void)
+{
+    lib::reset_operation_counters();
+    {
+        using any = lib::fitted_any<A, B>::type;
+        any                  a{A()};
+        any                  b{a};
+        lib::variant<int, A> v{A{}};
+        lib::variant<int, A> w{v};
+        w = 1;
+    }
+    lib::for_each_operation_counter([](const lib::operation_counter& counter) {
+        std::cout << counter.type_name << " copy:" << counter.copy << " move:" << counter.move
+                  << " delete:" << counter.destroy << std::endl;
+    });
+}
+
+void test_capacity(void)
+{
+    using any = lib::fitted_any<A, B>::type;
+    any a{A()};
+    any b{B()};
+    any c{1};
+    lib::for_each_capacity_record([](const lib::capacity_record& record) {
+        std::cout << record.type_name << " size:" << record.type_size << " capacity:" << record.capacity
+                  << " live:" << record.live << " peak:" << record.peak << " wasted:" << record.wasted() << std::endl;
+    });
+    std::cout << "live wasted bytes:" << lib::live_wasted_bytes() << std::endl;
+    const auto histogram = lib::make_capacity_histogram();
+    for (lib::size_t i = 0; i < histogram.bucket_count; ++i)
+    {
+        if (histogram.counts[i])
+        {
+            std::cout << ">=" << histogram.bucket_min(i) << ":" << histogram.counts[i] << std::endl;
+        }
+    }
+}
+
+int add(int lhs, int rhs) { return (lhs + rhs); }
+int sub(int lhs, int rhs) { return (lhs - rhs); }
+
+void test_function_pointer(void)
+{
+    lib::function<int(int, int), 16> a{add};
+    lib::function<int(int, int), 16> b{[](int lhs, int rhs) { return (lhs * rhs); }};
+    lib::function<int(int, int), 16> c = a;
+    std::cout << "function:" << a(2, 3) << " " << b(2, 3) << " " << c(4, 5) << std::endl;
+}
+
+void test_task_queue(void)
+{
+    lib::spsc_task_queue<8, 32> spsc;
+    lib::mpsc_task_queue<8, 32> mpsc;
+    int                         sum = 0;
+    for (int i = 1; i <= 4; ++i)
+    {
+        spsc.try_push([&sum, i] { sum += i; });
+        mpsc.try_push([&sum, i] { sum += i * 10; });
+    }
+    while (spsc.try_run())
+    {
+    }
+    lib::mpsc_task_queue<8, 32>::task_type task;
+    while (mpsc.try_pop(task))
+    {
+        task();
+    }
+    const bool rejected = !spsc.try_push(lib::spsc_task_queue<8, 32>::task_type{}) && !mpsc.try_push(nullptr);
+    std::cout << "task sum:" << sum << " empty:" << mpsc.empty() << " rejected:" << rejected << std::endl;
+}
+
+void test_thread_pool(void)
+{
+    lib::thread_pool<64> pool{2};
+    std::vector<int>     values(1000);
+    pool.parallel_for(0, values.size(), [&values](lib::size_t i) { values[i] = static_cast<int>(i); }, 64);
+    std::atomic<int> done{0};
+    pool.submit([&done] { ++done; });
+    while (!done.load())
+    {
+        std::this_thread::yield();
+    }
+    long sum = 0;
+    for (int value : values)
+    {
+        sum += value;
+    }
+    bool rethrown = false;
+    try
+    {
+        pool.parallel_for(0, 100, [](lib::size_t i) {
+            if (i == 42)
+            {
+                throw i;
+            }
+        });
+    }
+    catch (lib::size_t i)
+    {
+        rethrown = (i == 42);
+    }
+    std::cout << "pool sum:" << sum << " submitted:" << done.load() << " rethrown:" << rethrown << std::endl;
+}
+
+void test_timer_wheel(void)
+{
+    lib::timer_wheel<32, 16> wheel;
+    int                      fired = 0;
+    wheel.schedule(5, [&fired] { fired += 1; });
+    const lib::timer_handle late = wheel.schedule(500, [&fired] { fired += 100; });
+    wheel.schedule(1000, [&fired] { fired += 10; });
+    wheel.cancel(late);
+    wheel.advance(2000);
+    std::cout << "timer fired:" << fired << " now:" << wheel.now() << " pending:" << wheel.size() << std::endl;
+}
+
+void test_signal(void)
+{
+    lib::signal<void(int), 32, 4> sig;
+    int                           total = 0;
+    const lib::signal_handle      first = sig.connect([&total](int value) { total += value; });
+    sig.connect([&total](int value) { total += value * 10; });
+    sig.emit(1);
+    sig.disconnect(first);
+    sig(2);
+    std::cout << "signal total:" << total << " slots:" << sig.size() << std::endl;
+}
+
+struct shape
+{
+    virtual ~shape(void)            = default;
+    virtual double area(void) const = 0;
+};
+
+struct square : shape
+{
+    double side;
+    explicit square(double value) : side(value) {}
+    double area(void) const override { return (side * side); }
+};
+
+struct circle : shape
+{
+    double radius;
+    explicit circle(double value) : radius(value) {}
+    double area(void) const override { return (3.0 * radius * radius); }
+};
+
+void test_poly(void)
+{
+    lib::poly<shape, 32> a{square{2}};
+    lib::poly<shape, 32> b{lib::in_place_type_v<circle>::value, 1.0};
+    lib::poly<shape, 32> c{b};
+    std::cout << "poly area:" << a->area() << " ";
+    a = c;
+    std::cout << a->area() << " " << b->area() << std::endl;
+}
+
+LIB_ERASED_METHOD(draw_method, draw);
+LIB_ERASED_METHOD(length_method, length);
+
+using drawable = lib::interface<lib::method<draw_method, void(std::string&)>,
+                                lib::method<length_method, lib::size_t(void) const>>;
+
+struct label
+{
+    std::string text;
+    void        draw(std::string& out) { out += text; }
+    lib::size_t length(void) const { return (text.size()); }
+};
+
+void test_erased(void)
+{
+    lib::erased<drawable, 48> a{label{"erased"}};
+    const auto&               b = a;
+    std::string               out;
+    a.call<draw_method>(out);
+    std::cout << "erased:" << out << " " << b.call<length_method>() << std::endl;
+}
+
+void test_serialize(void)
+{
+    unsigned char              buffer[64];
+    lib::byte_writer           out(buffer, sizeof(buffer));
+    const lib::variant<int, T> written = T{3, 4};
+    const lib::any<16>         held{7};
+    const bool                 encoded = lib::encode(out, written) && lib::encode_any<int, T>(out, held);
+    lib::byte_reader           in(buffer, out.size());
+    lib::variant<int, T>       read;
+    lib::any<16>               restored;
+    const bool                 decoded = lib::decode(in, read) && lib::decode_any<int, T>(in, restored);
+    std::cout << "serialize:" << encoded << " " << decoded << " " << lib::get<T>(read).b << " "
+              << lib::any_cast<int>(restored) << std::endl;
+}
+
+void test_variant_span(void)
+{
+    const lib::variant<int, T> table[] = {1, T{2, 3}, 4};
+    const char* const          path    = "variant_table.bin";
+    std::FILE*                 file    = nullptr;
+#ifdef _MSC_VER
+    fopen_s(&file, path, "wb");
+#else
+    file = std::fopen(path, "wb");
+#endif
+    const bool written = file && lib::write_variant_table(file, table, 3);
+    if (file)
+    {
+        std::fclose(file);
+    }
+    {
+        lib::mapped_file mapped(path);
+        const auto       span = mapped.view<int, T>();
+        int        visited = 0;
+        const bool found   = span.visit(2, [&visited](const auto&) { ++visited; });
+        std::cout << "span:" << written << " " << span.size() << " " << span.get_if<T>(1)->b << " "
+                  << (span.at(5) == nullptr) << " " << found << " " << visited << std::endl;
+    }
+    std::remove(path);
+}
+
+void test_variant_compare(void)
+{
+    using variant = lib::variant<int, double>;
+
+    const variant            a = 1;
+    const variant            b = 2.5;
+    const variant            c = 1;
+    const lib::hash<variant> hasher;
+    std::cout << "compare:" << (a == c) << " " << (a != b) << " " << (a < b) << " " << (hasher(a) == hasher(c))
+              << std::endl;
+}
+
+void test_atomic_variant(void)
+{
+    lib::atomic_variant<int, float> value;
+    lib::variant<int, float>        expected  = 0;
+    const lib::variant<int, float>  desired   = 2.5f;
+    const bool                      exchanged = value.compare_exchange_strong(expected, desired);
+    lib::atomic_any<8>              held;
+    T                               loaded{};
+    held.store(T{5, 6});
+    const bool found = held.load(loaded);
+    std::cout << "atomic:" << exchanged << " " << lib::get<float>(value.load()) << " " << found << " " << loaded.b
+              << std::endl;
+}
+
+void test_try_any_cast(void)
+{
+    lib::any<16> a{5};
+    lib::any<16> empty;
+    const auto   hit  = lib::try_any_cast<int>(a);
+    const auto   miss = lib::try_any_cast<float>(a);
+    const auto   none = lib::try_any_cast<int>(empty);
+    std::cout << "try cast:" << *hit << " " << static_cast<int>(miss.error()) << " "
+              << static_cast<int>(none.error()) << " " << lib::any_cast<int>(a) << std::endl;
+}
+
+constexpr lib::variant<int, double, T> constant_table[] = {1, 2.5, T{3, 4}};
+static_assert(constant_table[2].index() == 2, "");
+
+struct no_default
+{
+    int value;
+    explicit no_default(int init) : value(init) {}
+};
+
+void test_constexpr_variant(void)
+{
+    static_assert(lib::get<T>(constant_table[2]).b == 4, "");
+    std::cout << "constexpr:" << lib::get<double>(constant_table[1]) << " " << constant_table[0].index() << std::endl;
+
+    lib::variant<no_default, int>       a{no_default(1)};
+    const lib::variant<no_default, int> b     = 2;
+    lib::variant<int, std::string>      alias = std::string("alias");
+    a     = b;
+    alias = lib::get<std::string>(alias);
+    std::cout << "assign:" << lib::get<int>(a) << " " << lib::get<std::string>(alias) << std::endl;
+}
+
+using binary_function = lib::function<int(int, int), 0>;
+
+constexpr binary_function function_table[] = {add, sub};
+
+LIB_CONSTINIT const lib::function<int(int, int), 16> constant_function{add};
+
+void test_function_table(void)
+{
+    std::cout << "function table:" << function_table[0](2, 3) << " " << function_table[1](2, 3) << " "
+              << constant_function(4, 5) << std::endl;
+}
+
+void test_type_id(void)
+{
+    lib::any<16> a{1};
+    std::cout << "type id:" << (a.type() == lib::type_id<int>()) << " " << (lib::type_id<int>() != lib::type_id<long>())
+              << " " << lib::type_name<int>() << " stable:" << lib::stable_type_id<int>::value << " "
+              << lib::stable_type_id<T>::value << std::endl;
+}
+
+struct tree_node;
+using tree = lib::variant<int, lib::arena_box<tree_node>>;
+struct tree_node
+{
+    int  value;
+    tree next;
+};
+
+void test_box(void)
+{
+    lib::monotonic_arena arena{1024};
+    tree                 list{0};
+    for (int i = 1; i <= 3; ++i)
+    {
+        tree node{lib::make_arena_box<tree_node>(arena, tree_node{i, lib::move(list)})};
+        list = lib::move(node);
+    }
+    int sum = 0;
+    for (const tree* it = &list; it->index() == 1; it = &lib::get<1>(*it)->next)
+    {
+        sum += lib::get<1>(*it)->value;
+    }
+    lib::box<int> boxed{arena, 7};
+    lib::box<int> copy = boxed;
+    std::cout << "box sum:" << sum << " " << *copy << " " << (copy == boxed) << std::endl;
+}
+
+void test_variant_column(void)
+{
+    using column_type = lib::variant_column<int, double>;
+
+    unsigned char storage[column_type::storage_size(16)];
+    column_type   column{storage, sizeof(storage)};
+    column.emplace_back<int>(1);
+    column.emplace_back<double>(2.5);
+    column.push_back(lib::variant<int, double>{3});
+    double sum = 0;
+    column.for_each_of<double>([&sum](double value) { sum += value; });
+    std::cout << "column:" << column.size() << " ints:" << column.count_of<int>() << " doubles:" << sum << std::endl;
+}
+
+void test_range(void)
+{
+    using any = lib::any<32>;
+    any source[4];
+    any target[4];
+    any moved[4];
+    source[0].emplace<int>(1);
+    source[1].emplace<std::string>("range");
+    source[3].emplace<double>(2.5);
+    lib::copy_n(source, 4, target);
+    lib::relocate_n(target, 4, moved);
+    std::cout << "range:" << *lib::any_cast<std::string>(&moved[1]) << " " << target[1].has_value() << " ";
+    lib::destroy_n(moved, 4);
+    lib::destroy_n(source, 4);
+    std::cout << moved[1].has_value() << " " << source[0].has_value() << std::endl;
+}
+
+void test_parallel(void)
+{
+    using variant = lib::variant<int, double>;
+
+    lib::thread_pool<64> pool{2};
+    std::vector<variant> values(100);
+    for (lib::size_t i = 0; i < values.size(); ++i)
+    {
+        values[i] = (i % 2) ? variant{static_cast<int>(i)} : variant{0.5};
+    }
+    const double total = lib::parallel_reduce(
+        pool, values.data(), values.size(), 0.0, [](auto value) { return (static_cast<double>(value)); },
+        [](double lhs, double rhs) { return (lhs + rhs); });
+    std::vector<lib::any<16>> anys(10, lib::any<16>{2});
+    std::atomic<int>          count{0};
+    lib::parallel_visit<int>(pool, anys.data(), anys.size(), [&count](int value) { count += value; });
+    std::cout << "parallel:" << total << " " << count.load() << std::endl;
+}
+
+void test_shared(void)
+{
+    lib::any<16> a;
+    a.emplace_shared<std::string>(64, 's');
+    lib::any<16> b      = a;
+    const bool   shared = lib::any_cast<const std::string>(&a) == lib::any_cast<const std::string>(&b);
+    lib::any_cast<std::string&>(b) += "!";
+    const bool unshared = lib::any_cast<const std::string>(&a) != lib::any_cast<const std::string>(&b);
+    std::cout << "shared:" << shared << " " << unshared << " " << lib::any_cast<const std::string&>(b).size()
+              << std::endl;
+}
+
+void test_inplace(void)
+{
+    lib::inplace_vector<int, 2> values;
+    values.push_back(1);
+    values.push_back(2);
+    const bool              overflow = values.push_back(3);
+    lib::inplace_string<16> name     = "inplace";
+    name.append("_string");
+    std::cout << "inplace:" << values.size() << " " << values.back() << " " << overflow << " " << name.c_str()
+              << std::endl;
+}
+
 int main()
 {
     // std::visit();
     test_any();
     test_variant();
+    test_trace();
+    test_capacity();
+    test_function_pointer();
+    test_task_queue();
+    test_thread_pool();
+    test_timer_wheel();
+    test_signal();
+    test_poly();
+    test_erased();
+    test_serialize();
+    test_variant_span();
+    test_variant_compare();
+    test_atomic_variant();
+    test_try_any_cast();
+    test_constexpr_variant();
+    test_function_table();
+    test_type_id();
+    test_box();
+    test_variant_column();
+    test_range();
+    test_parallel();
+    test_shared();
+    test_inplace();
     return 0;
 }
@@ -2,6 +2,23 @@
 
 #include "type_traits.h"
 #include "new.h"
+#include "trace.h"
+#include "capacity.h"
+#include "hash.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#if defined(__cpp_constinit)
+#define LIB_CONSTINIT constinit
+#elif defined(__clang__)
+#define LIB_CONSTINIT [[clang::require_constant_initialization]]
+#elif defined(__GNUC__) && __GNUC__ >= 10
+#define LIB_CONSTINIT __constinit
+#else
+#define LIB_CONSTINIT
+#endif
 
 namespace lib
 {
@@ -13,8 +30,80 @@ enum class _any_operater
     Delete,
     Copy,
     Move,
+    Signature,
+    TypeId,
+    DeleteRange,
+    CopyRange,
+    MoveRange,
+    Target,
+    MutableTarget,
+    Capacity,
+    TrivialDelete,
 };
 
+struct _any_range
+{
+    const void* src;
+    size_t      src_stride;
+    void*       dst;
+    size_t      dst_stride;
+    size_t      count;
+};
+
+template <class T>
+using _trivial_delete = bool_constant<is_trivially_destructible<T>::value && !_trace_policy::enabled>;
+
+template <class T>
+void _delete_n(const _any_range& range) noexcept
+{
+    auto* src = static_cast<const char*>(range.src);
+    for (size_t i = 0; i < range.count; ++i, src += range.src_stride)
+    {
+        _trace_policy::record<T>(trace_operation::Delete, src);
+        reinterpret_cast<const T*>(src)->~T();
+    }
+}
+
+template <class T>
+void _copy_n(const _any_range& range)
+{
+    struct rollback
+    {
+        const _any_range& range;
+        size_t            done;
+        ~rollback(void) { _delete_n<T>(_any_range{range.dst, range.dst_stride, nullptr, 0, done}); }
+    } guard{range, 0};
+    auto* src = static_cast<const char*>(range.src);
+    auto* dst = static_cast<char*>(range.dst);
+    for (; guard.done < range.count; ++guard.done, src += range.src_stride, dst += range.dst_stride)
+    {
+        _trace_policy::record<T>(trace_operation::Copy, dst);
+        ::new (dst) T(*reinterpret_cast<const T*>(src));
+    }
+    guard.done = 0;
+}
+
+template <class T>
+void _move_n(const _any_range& range) noexcept
+{
+    auto* src = static_cast<const char*>(range.src);
+    auto* dst = static_cast<char*>(range.dst);
+    for (size_t i = 0; i < range.count; ++i, src += range.src_stride, dst += range.dst_stride)
+    {
+        auto* const p = reinterpret_cast<T*>(const_cast<char*>(src));
+        _trace_policy::record<T>(trace_operation::Move, dst);
+        ::new (dst) T(::lib::move(*p));
+        p->~T();
+    }
+}
+
+template <class Manager>
+void _capacity_answer(void* dst) noexcept
+{
+    auto* query   = static_cast<_capacity_query*>(dst);
+    query->record = _capacity_lookup<Manager>(query->capacity, query->align);
+}
+
 template <class T>
 struct _any_manager
 {
@@ -24,53 +113,125 @@ struct _any_manager
         switch (ope)
         {
         case _any_operater::Delete:
+            _trace_policy::record<T>(trace_operation::Delete, src);
             p->~T();
             break;
         case _any_operater::Copy:
+            _trace_policy::record<T>(trace_operation::Copy, dst);
             ::new (dst) T(*p);
             break;
         case _any_operater::Move:
-            ::new (dst) T(move(*const_cast<T*>(p)));
+            _trace_policy::record<T>(trace_operation::Move, dst);
+            ::new (dst) T(::lib::move(*const_cast<T*>(p)));
             p->~T();
             break;
+        case _any_operater::Signature:
+            *static_cast<const char**>(dst) = _type_signature<T>();
+            break;
+        case _any_operater::TypeId:
+            *static_cast<type_id_t*>(dst) = type_id<T>();
+            break;
+        case _any_operater::DeleteRange:
+            _delete_n<T>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::CopyRange:
+            _copy_n<T>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::MoveRange:
+            _move_n<T>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::Target:
+        case _any_operater::MutableTarget:
+            *static_cast<void**>(dst) = const_cast<T*>(p);
+            break;
+        case _any_operater::Capacity:
+            _capacity_answer<_any_manager>(dst);
+            break;
+        case _any_operater::TrivialDelete:
+            *static_cast<bool*>(dst) = _trivial_delete<T>::value;
+            break;
         default:
             break;
         }
     }
 };
 
-using _any_invoker_type = void (*)(const void* src, void* dst, _any_operater ope);
-
-struct bit64_tag
-{};
-struct bit32_tag
-{};
-using bit_size_tag = conditional_t<(sizeof(void*) == 8), bit64_tag, bit32_tag>;
+template <class T>
+struct _unique_any_manager
+{
+    static void invoke(const void* src, void* dst, _any_operater ope) noexcept
+    {
+        auto* p = static_cast<const T*>(src);
+        switch (ope)
+        {
+        case _any_operater::Delete:
+            _trace_policy::record<T>(trace_operation::Delete, src);
+            p->~T();
+            break;
+        case _any_operater::Move:
+            _trace_policy::record<T>(trace_operation::Move, dst);
+            ::new (dst) T(::lib::move(*const_cast<T*>(p)));
+            p->~T();
+            break;
+        case _any_operater::Signature:
+            *static_cast<const char**>(dst) = _type_signature<T>();
+            break;
+        case _any_operater::TypeId:
+            *static_cast<type_id_t*>(dst) = type_id<T>();
+            break;
+        case _any_operater::DeleteRange:
+            _delete_n<T>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::MoveRange:
+            _move_n<T>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::Target:
+        case _any_operater::MutableTarget:
+            *static_cast<void**>(dst) = const_cast<T*>(p);
+            break;
+        case _any_operater::Capacity:
+            _capacity_answer<_unique_any_manager>(dst);
+            break;
+        case _any_operater::TrivialDelete:
+            *static_cast<bool*>(dst) = _trivial_delete<T>::value;
+            break;
+        default:
+            break;
+        }
+    }
+};
 
-template <class Tag>
-struct hash_param;
+using _any_invoker_type = void (*)(const void* src, void* dst, _any_operater ope);
 
-template <>
-struct hash_param<bit64_tag>
+struct _match_address
 {
-    static constexpr size_t fnv_prime    = 1099511628211ull;
-    static constexpr size_t offset_basis = 14695981039346656037ull;
+    template <class T>
+    static bool foreign(_any_invoker_type) noexcept
+    {
+        return (false);
+    }
 };
 
-template <>
-struct hash_param<bit32_tag>
+struct _match_type_id
 {
-    static constexpr size_t fnv_prime    = 16777619ull;
-    static constexpr size_t offset_basis = 2166136261ull;
+    template <class T>
+    static bool foreign(_any_invoker_type invoker) noexcept
+    {
+        if (!stable_type_id<T>::value)
+        {
+            return (false);
+        }
+        type_id_t id = 0;
+        invoker(nullptr, &id, _any_operater::TypeId);
+        return (id == type_id<T>());
+    }
 };
 
-using hash_param_t = hash_param<bit_size_tag>;
-
-inline constexpr size_t calc_fnv1a_hash(const char* values, size_t index)
-{
-    return (((index ? calc_fnv1a_hash(values, index - 1) : hash_param_t::offset_basis) ^ values[index]) *
-            hash_param_t::fnv_prime);
-}
+#ifdef LIB_STABLE_TYPE_ID
+using _match_policy = _match_type_id;
+#else
+using _match_policy = _match_address;
+#endif
 }
 
 constexpr size_t operator"" _hash(const char* str, size_t length) { return internal::calc_fnv1a_hash(str, length - 1); }
@@ -89,8 +250,166 @@ struct in_place_type_v
 
 namespace internal
 {
+inline long _refcount_increment(long& refs) noexcept
+{
+#ifdef _MSC_VER
+    return (_InterlockedIncrement(&refs));
+#else
+    return (__atomic_add_fetch(&refs, 1, __ATOMIC_RELAXED));
+#endif
+}
+
+inline long _refcount_decrement(long& refs) noexcept
+{
+#ifdef _MSC_VER
+    return (_InterlockedDecrement(&refs));
+#else
+    return (__atomic_sub_fetch(&refs, 1, __ATOMIC_ACQ_REL));
+#endif
+}
 
-class _any
+inline long _refcount_load(long& refs) noexcept
+{
+#ifdef _MSC_VER
+    return (_InterlockedCompareExchange(&refs, 0, 0));
+#else
+    return (__atomic_load_n(&refs, __ATOMIC_ACQUIRE));
+#endif
+}
+
+template <class T>
+struct _shared_block
+{
+    long refs;
+    T    value;
+
+    template <class... Args>
+    explicit _shared_block(Args&&... args) : refs(1), value(::lib::forward<Args>(args)...)
+    {}
+};
+
+template <class T>
+class _shared_handle
+{
+private:
+    _shared_block<T>* _block;
+
+public:
+    template <class... Args>
+    explicit _shared_handle(in_place_type_t<T>, Args&&... args) :
+        _block(new _shared_block<T>(::lib::forward<Args>(args)...))
+    {}
+
+    _shared_handle(const _shared_handle& rhs) noexcept : _block(rhs._block) { _refcount_increment(_block->refs); }
+
+    _shared_handle(_shared_handle&& rhs) noexcept : _block(rhs._block) { rhs._block = nullptr; }
+
+    _shared_handle& operator=(const _shared_handle&) = delete;
+
+    ~_shared_handle(void) { _release(); }
+
+    const T& get(void) const noexcept { return (_block->value); }
+
+    T& get_mutable(void)
+    {
+        if (_refcount_load(_block->refs) != 1)
+        {
+            _shared_block<T>* const copy = new _shared_block<T>(_block->value);
+            _release();
+            _block = copy;
+        }
+        return (_block->value);
+    }
+
+    long use_count(void) const noexcept { return (_refcount_load(_block->refs)); }
+
+private:
+    void _release(void) noexcept
+    {
+        if (_block && !_refcount_decrement(_block->refs))
+        {
+            delete _block;
+        }
+    }
+};
+
+template <class T>
+struct _shared_any_manager
+{
+    static void invoke(const void* src, void* dst, _any_operater ope)
+    {
+        using handle = _shared_handle<T>;
+        auto* p      = static_cast<const handle*>(src);
+        switch (ope)
+        {
+        case _any_operater::Delete:
+            _trace_policy::record<handle>(trace_operation::Delete, src);
+            p->~handle();
+            break;
+        case _any_operater::Copy:
+            _trace_policy::record<handle>(trace_operation::Copy, dst);
+            ::new (dst) handle(*p);
+            break;
+        case _any_operater::Move:
+            _trace_policy::record<handle>(trace_operation::Move, dst);
+            ::new (dst) handle(::lib::move(*const_cast<handle*>(p)));
+            p->~handle();
+            break;
+        case _any_operater::Signature:
+            *static_cast<const char**>(dst) = _type_signature<T>();
+            break;
+        case _any_operater::TypeId:
+            *static_cast<type_id_t*>(dst) = type_id<T>();
+            break;
+        case _any_operater::DeleteRange:
+            _delete_n<handle>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::CopyRange:
+            _copy_n<handle>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::MoveRange:
+            _move_n<handle>(*static_cast<const _any_range*>(dst));
+            break;
+        case _any_operater::Target:
+            *static_cast<void**>(dst) = const_cast<T*>(&p->get());
+            break;
+        case _any_operater::MutableTarget:
+            *static_cast<void**>(dst) = &const_cast<handle*>(p)->get_mutable();
+            break;
+        case _any_operater::Capacity:
+            _capacity_answer<_shared_any_manager>(dst);
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+template <template <class> class Manager, class T>
+struct _shared_invoker
+{
+    static constexpr _any_invoker_type value = nullptr;
+};
+
+template <class T>
+struct _shared_invoker<_any_manager, T>
+{
+    static constexpr _any_invoker_type value = _shared_any_manager<T>::invoke;
+};
+
+struct _capacity_by_invoker
+{
+    _any_invoker_type invoker;
+
+    capacity_record* operator()(size_t capacity, size_t align) const noexcept
+    {
+        _capacity_query query{capacity, align, nullptr};
+        invoker(nullptr, &query, _any_operater::Capacity);
+        return (query.record);
+    }
+};
+
+class _any : private _capacity_slot
 {
 private:
     void* const                 _buffer;
@@ -99,23 +418,156 @@ private:
 public:
     bool has_value(void) const noexcept { return (_invoker); }
 
+    type_id_t type(void) const noexcept
+    {
+        type_id_t id = 0;
+        if (_invoker)
+        {
+            _invoker(_buffer, &id, internal::_any_operater::TypeId);
+        }
+        return (id);
+    }
+
+    void* _get_buffer(void) const noexcept { return (_buffer); }
+
+    const char* _signature(void) const noexcept
+    {
+        const char* name = nullptr;
+        if (_invoker)
+        {
+            _invoker(_buffer, &name, internal::_any_operater::Signature);
+        }
+        return (name);
+    }
+
     void reset(void) noexcept
     {
         if (_invoker)
         {
+            _capacity_release();
             _invoker(_buffer, nullptr, internal::_any_operater::Delete);
             _invoker = nullptr;
         }
     }
 
-    template <class T>
+    template <class T, template <class> class Manager = internal::_any_manager>
     T* _cast(void) const
     {
-        return (_invoker == internal::_any_manager<decay_t<T>>::invoke ? static_cast<decay_t<T>*>(_buffer) : nullptr);
+        using Decayed = decay_t<T>;
+        if (_invoker == Manager<Decayed>::invoke)
+        {
+            return (static_cast<Decayed*>(_buffer));
+        }
+        if (_invoker && (_invoker == internal::_shared_invoker<Manager, Decayed>::value ||
+                         internal::_match_policy::foreign<Decayed>(_invoker)))
+        {
+            return (static_cast<Decayed*>(_target(is_const<T>::value)));
+        }
+        return (nullptr);
+    }
+
+    template <class T>
+    T* _access(void) const
+    {
+        using Decayed = decay_t<T>;
+        if (_invoker == internal::_shared_invoker<internal::_any_manager, Decayed>::value)
+        {
+            return (static_cast<Decayed*>(_target(is_const<T>::value)));
+        }
+        return (static_cast<Decayed*>(_buffer));
+    }
+
+    template <class Decayed, template <class> class Manager = internal::_any_manager, class Constructor>
+    bool _construct_with(Constructor&& construct)
+    {
+        return (_construct_raw(Manager<Decayed>::invoke, ::lib::forward<Constructor>(construct)));
+    }
+
+    template <class Constructor>
+    bool _construct_raw(internal::_any_invoker_type invoker, Constructor&& construct)
+    {
+        reset();
+        if (!invoker || !construct(_buffer))
+        {
+            return (false);
+        }
+        _invoker = invoker;
+        _capacity_acquire(internal::_capacity_by_invoker{_invoker});
+        return (true);
+    }
+
+    static void _destroy_n(_any* first, size_t stride, size_t count) noexcept
+    {
+        internal::_any_invoker_type queried = nullptr;
+        bool                        trivial = false;
+        for (size_t i = 0, run = 0; i < count; i += run)
+        {
+            _any&                             head    = _at(first, stride, i);
+            const internal::_any_invoker_type invoker = head._invoker;
+            run                                       = _release_run(first, stride, i, count);
+            if (invoker && invoker != queried)
+            {
+                queried = invoker;
+                trivial = false;
+                invoker(nullptr, &trivial, internal::_any_operater::TrivialDelete);
+            }
+            if (invoker && !trivial)
+            {
+                internal::_any_range range{head._buffer, stride, nullptr, 0, run};
+                invoker(nullptr, &range, internal::_any_operater::DeleteRange);
+            }
+        }
+    }
+
+    static void _copy_n(const _any* src, size_t src_stride, size_t count, _any* dst, size_t dst_stride)
+    {
+        _destroy_n(dst, dst_stride, count);
+        for (size_t i = 0, run = 0; i < count; i += run)
+        {
+            const _any& head = _at(src, src_stride, i);
+            run              = _run_length(src, src_stride, i, count);
+            if (head._invoker)
+            {
+                internal::_any_range range{head._buffer, src_stride, _at(dst, dst_stride, i)._buffer, dst_stride,
+                                           run};
+                head._invoker(nullptr, &range, internal::_any_operater::CopyRange);
+                for (size_t j = i; j < i + run; ++j)
+                {
+                    _any& element    = _at(dst, dst_stride, j);
+                    element._invoker = head._invoker;
+                    element._capacity_acquire(internal::_capacity_by_invoker{element._invoker});
+                }
+            }
+        }
+    }
+
+    static void _relocate_n(_any* src, size_t src_stride, size_t count, _any* dst, size_t dst_stride) noexcept
+    {
+        _destroy_n(dst, dst_stride, count);
+        for (size_t i = 0, run = 0; i < count; i += run)
+        {
+            _any&                             head    = _at(src, src_stride, i);
+            const internal::_any_invoker_type invoker = head._invoker;
+            run                                       = _release_run(src, src_stride, i, count);
+            if (invoker)
+            {
+                internal::_any_range range{head._buffer, src_stride, _at(dst, dst_stride, i)._buffer, dst_stride,
+                                           run};
+                invoker(nullptr, &range, internal::_any_operater::MoveRange);
+                for (size_t j = i; j < i + run; ++j)
+                {
+                    _any& element    = _at(dst, dst_stride, j);
+                    element._invoker = invoker;
+                    element._capacity_acquire(internal::_capacity_by_invoker{invoker});
+                }
+            }
+        }
     }
 
 protected:
-    explicit _any(char* buffer) noexcept : _buffer(buffer) {}
+    constexpr explicit _any(char* buffer, size_t capacity, size_t align) noexcept :
+        _capacity_slot(capacity, align), _buffer(buffer)
+    {}
 
     ~_any(void) noexcept { reset(); }
 
@@ -126,6 +578,7 @@ protected:
         {
             rhs._invoker(rhs._buffer, _buffer, internal::_any_operater::Copy);
             _invoker = rhs._invoker;
+            _capacity_acquire(internal::_capacity_by_invoker{_invoker});
         }
     }
 
@@ -134,25 +587,157 @@ protected:
         reset();
         if (rhs._invoker)
         {
+            rhs._capacity_release();
             rhs._invoker(rhs._buffer, _buffer, internal::_any_operater::Move);
             _invoker     = rhs._invoker;
             rhs._invoker = nullptr;
+            _capacity_acquire(internal::_capacity_by_invoker{_invoker});
         }
     }
 
-    template <class Decayed, class... Args>
+    template <class Decayed, template <class> class Manager = internal::_any_manager, class... Args>
     Decayed& _emplace(Args&&... args)
     {
         reset();
-        _invoker = internal::_any_manager<Decayed>::invoke;
-        new (_buffer) Decayed{forward<Args>(args)...};
+        _invoker = Manager<Decayed>::invoke;
+        new (_buffer) Decayed{::lib::forward<Args>(args)...};
+        _capacity_acquire(internal::_capacity_by_invoker{_invoker});
         return (*static_cast<Decayed*>(_buffer));
     }
+
+    template <class Decayed, size_t SIZE, size_t ALIGN, template <class> class Manager = internal::_any_manager,
+              class Stored = Decayed>
+    static void _record_capacity(void) noexcept
+    {
+        _capacity_list<Stored, SIZE, ALIGN>();
+        _capacity_record<Stored, SIZE, ALIGN, Manager<Decayed>>();
+    }
+
+private:
+    void* _target(bool readonly) const
+    {
+        void*                         target = nullptr;
+        const internal::_any_operater ope    = readonly ? internal::_any_operater::Target
+                                                       : internal::_any_operater::MutableTarget;
+        _invoker(_buffer, &target, ope);
+        return (target);
+    }
+
+    template <class Any>
+    static Any& _at(Any* first, size_t stride, size_t index) noexcept
+    {
+        return (*reinterpret_cast<Any*>(reinterpret_cast<uintptr_t>(first) + stride * index));
+    }
+
+    static size_t _run_length(const _any* first, size_t stride, size_t begin, size_t count) noexcept
+    {
+        const _any_invoker_type invoker = _at(first, stride, begin)._invoker;
+        size_t                  end     = begin + 1;
+        while (end < count && _at(first, stride, end)._invoker == invoker)
+        {
+            ++end;
+        }
+        return (end - begin);
+    }
+
+    static size_t _release_run(_any* first, size_t stride, size_t begin, size_t count) noexcept
+    {
+        const _any_invoker_type invoker = _at(first, stride, begin)._invoker;
+        size_t                  end     = begin;
+        for (; end < count; ++end)
+        {
+            _any& element = _at(first, stride, end);
+            if (element._invoker != invoker)
+            {
+                break;
+            }
+            if (invoker)
+            {
+                element._capacity_release();
+                element._invoker = nullptr;
+            }
+        }
+        return (end - begin);
+    }
 };
 }
 
+using cast_failure_hook_type = void (*)(const char* expected, const char* actual);
+
+enum class any_cast_error
+{
+    None,
+    Empty,
+    TypeMismatch,
+};
+
+namespace internal
+{
+inline cast_failure_hook_type& _cast_failure_hook(void) noexcept
+{
+    static cast_failure_hook_type hook = nullptr;
+    return (hook);
+}
+
+[[noreturn]] inline void _cast_failed(const char* expected, const char* actual) noexcept
+{
+    if (auto hook = _cast_failure_hook())
+    {
+        hook(expected, actual);
+    }
+#ifdef _MSC_VER
+    __fastfail(7);
+#else
+    __builtin_trap();
+#endif
+}
+
+struct _cast_checked
+{
+    template <class U>
+    static U* get(const _any& target) noexcept(is_const<U>::value)
+    {
+        U* const value = target._cast<U>();
+        if (!value)
+        {
+            _cast_failed(_type_signature<decay_t<U>>(), target._signature());
+        }
+        return (value);
+    }
+};
+
+struct _cast_unchecked
+{
+    template <class U>
+    static U* get(const _any& target) noexcept(is_const<U>::value)
+    {
+#ifndef NDEBUG
+        if (!target.has_value())
+        {
+            _cast_failed(_type_signature<decay_t<U>>(), nullptr);
+        }
+#endif
+        return (target._access<U>());
+    }
+};
+
+#if defined(LIB_UNCHECKED_ANY_CAST) || (defined(NDEBUG) && !defined(LIB_CHECKED_ANY_CAST))
+using _cast_policy = _cast_unchecked;
+#else
+using _cast_policy = _cast_checked;
+#endif
+}
+
+inline cast_failure_hook_type set_cast_failure_hook(cast_failure_hook_type hook) noexcept
+{
+    const cast_failure_hook_type previous = internal::_cast_failure_hook();
+    internal::_cast_failure_hook()        = hook;
+    return (previous);
+}
+
+// Mutable casts copy a shared payload that other handles still refer to, so only const casts are noexcept.
 template <class T>
-T* any_cast(internal::_any* target) noexcept
+T* any_cast(internal::_any* target) noexcept(is_const<T>::value)
 {
     return (target ? target->_cast<T>() : nullptr);
 }
@@ -160,15 +745,16 @@ T* any_cast(internal::_any* target) noexcept
 template <class T>
 const T* any_cast(const internal::_any* target) noexcept
 {
-    return (target ? target->_cast<T>() : nullptr);
+    return (target ? target->_cast<const T>() : nullptr);
 }
 
 template <class T>
 T any_cast(internal::_any& target)
 {
     using U = remove_cvref_t<T>;
-    static_assert(is_constructible<T, const U&>::value, "T is not constructible");
-    return (*any_cast<U>(&target));
+    using V = conditional_t<is_lvalue_reference<T>::value && !is_const<remove_reference_t<T>>::value, U, const U>;
+    static_assert(is_constructible<T, V&>::value, "T is not constructible");
+    return (*internal::_cast_policy::get<V>(target));
 }
 
 template <class T>
@@ -176,7 +762,7 @@ T any_cast(const internal::_any& target)
 {
     using U = remove_cvref_t<T>;
     static_assert(is_constructible<T, U&>::value, "T is not constructible");
-    return (*any_cast<U>(&target));
+    return (*internal::_cast_policy::get<const U>(target));
 }
 
 template <class T>
@@ -184,7 +770,51 @@ T any_cast(internal::_any&& target)
 {
     using U = remove_cvref_t<T>;
     static_assert(is_constructible<T, U>::value, "T is not constructible");
-    return (move(*any_cast<U>(&target)));
+    return (::lib::move(*internal::_cast_policy::get<U>(target)));
+}
+
+template <class T>
+class cast_result
+{
+private:
+    T*             _value;
+    any_cast_error _error;
+
+public:
+    constexpr cast_result(T* value, any_cast_error error) noexcept : _value(value), _error(error) {}
+
+    constexpr explicit operator bool(void) const noexcept { return (_value); }
+    constexpr bool           has_value(void) const noexcept { return (_value); }
+    constexpr any_cast_error error(void) const noexcept { return (_error); }
+
+    constexpr T& value(void) const noexcept { return (*_value); }
+    constexpr T& operator*(void) const noexcept { return (*_value); }
+    constexpr T* operator->(void) const noexcept { return (_value); }
+};
+
+template <class T>
+cast_result<remove_volatile_t<remove_reference_t<T>>> try_any_cast(internal::_any& target) noexcept(
+    is_const<remove_reference_t<T>>::value)
+{
+    using U = remove_volatile_t<remove_reference_t<T>>;
+    if (!target.has_value())
+    {
+        return (cast_result<U>{nullptr, any_cast_error::Empty});
+    }
+    U* const value = target._cast<U>();
+    return (cast_result<U>{value, value ? any_cast_error::None : any_cast_error::TypeMismatch});
+}
+
+template <class T>
+cast_result<const remove_cvref_t<T>> try_any_cast(const internal::_any& target) noexcept
+{
+    using U = const remove_cvref_t<T>;
+    if (!target.has_value())
+    {
+        return (cast_result<U>{nullptr, any_cast_error::Empty});
+    }
+    U* const value = target._cast<U>();
+    return (cast_result<U>{value, value ? any_cast_error::None : any_cast_error::TypeMismatch});
 }
 
 template <size_t SIZE, size_t ALIGN = alignof(max_align_t)>
@@ -194,29 +824,31 @@ private:
     alignas(ALIGN) char _buffer[SIZE]{};
 
 public:
-    constexpr any(void) noexcept : _any(_buffer) {}
+    constexpr any(void) noexcept : _any(_buffer, SIZE, ALIGN) {}
 
-    any(const any& rhs) : _any(_buffer) { copy_data(rhs); }
+    any(const any& rhs) : _any(_buffer, SIZE, ALIGN) { copy_data(rhs); }
 
-    any(any&& rhs) noexcept : _any(_buffer) { move_data(move(rhs)); }
+    any(any&& rhs) noexcept : _any(_buffer, SIZE, ALIGN) { move_data(::lib::move(rhs)); }
 
     template <class T, disable_if_t<disjunction<is_same<any, decay_t<T>>,
                                                 is_template_of<in_place_type_t, decay_t<T>>>::value>* = nullptr>
-    explicit any(T&& data) : _any(_buffer)
+    explicit any(T&& data) : _any(_buffer, SIZE, ALIGN)
     {
         static_assert(!is_same_template<any, decay_t<T>>::value, "size or align is different");
         static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
         static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
-        _emplace<decay_t<T>>(forward<T>(data));
+        _record_capacity<decay_t<T>, SIZE, ALIGN>();
+        _emplace<decay_t<T>>(::lib::forward<T>(data));
     }
 
     template <class T, class... Args>
-    explicit any(in_place_type_t<T>, Args&&... data) : _any(_buffer)
+    explicit any(in_place_type_t<T>, Args&&... data) : _any(_buffer, SIZE, ALIGN)
     {
         static_assert(!is_same_template<any, decay_t<T>>::value, "size or align is different");
         static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
         static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
-        _emplace<decay_t<T>>(forward<Args>(data)...);
+        _record_capacity<decay_t<T>, SIZE, ALIGN>();
+        _emplace<decay_t<T>>(::lib::forward<Args>(data)...);
     }
 
     any& operator=(const any& rhs)
@@ -232,7 +864,7 @@ public:
     {
         if (this != &rhs)
         {
-            move_data(move(rhs));
+            move_data(::lib::move(rhs));
         }
         return (*this);
     }
@@ -244,7 +876,8 @@ public:
         static_assert(!is_same_template<any, decay_t<T>>::value, "size or align is different");
         static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
         static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
-        _emplace<decay_t<T>>(forward<T>(data));
+        _record_capacity<decay_t<T>, SIZE, ALIGN>();
+        _emplace<decay_t<T>>(::lib::forward<T>(data));
         return (*this);
     }
 
@@ -253,7 +886,23 @@ public:
     {
         static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
         static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
-        return (_emplace<decay_t<T>>(forward<Args>(args)...));
+        _record_capacity<decay_t<T>, SIZE, ALIGN>();
+        return (_emplace<decay_t<T>>(::lib::forward<Args>(args)...));
+    }
+
+    template <class T, class... Args>
+    const decay_t<T>& emplace_shared(Args&&... args)
+    {
+        using Decayed = decay_t<T>;
+        using Handle  = internal::_shared_handle<Decayed>;
+        static_assert(sizeof(Handle) <= SIZE, "Insufficient size");
+        static_assert(ALIGN % alignof(Handle) == 0, "Alignment is incorrect");
+        _record_capacity<Decayed, SIZE, ALIGN, internal::_shared_any_manager, Handle>();
+        _construct_with<Decayed, internal::_shared_any_manager>([&args...](void* dst) {
+            ::new (dst) Handle(in_place_type_t<Decayed>{}, ::lib::forward<Args>(args)...);
+            return (true);
+        });
+        return (static_cast<const Handle*>(_get_buffer())->get());
     }
 
     void swap(any& rhs) noexcept
@@ -276,7 +925,7 @@ public:
             any* const src = has_value() ? this : &rhs;
             any* const dst = has_value() ? &rhs : this;
 
-            *dst = move(*src);
+            *dst = ::lib::move(*src);
         }
     }
 };
@@ -287,8 +936,76 @@ void swap(any<SIZE, ALIGN>& lhs, any<SIZE, ALIGN>& rhs) noexcept
     lhs.swap(rhs);
 }
 
+template <size_t SIZE, size_t ALIGN>
+void destroy_n(any<SIZE, ALIGN>* first, size_t count) noexcept
+{
+    if (count)
+    {
+        internal::_any::_destroy_n(first, sizeof(any<SIZE, ALIGN>), count);
+    }
+}
+
+template <size_t SIZE, size_t ALIGN>
+void copy_n(const any<SIZE, ALIGN>* src, size_t count, any<SIZE, ALIGN>* dst)
+{
+    if (count)
+    {
+        internal::_any::_copy_n(src, sizeof(any<SIZE, ALIGN>), count, dst, sizeof(any<SIZE, ALIGN>));
+    }
+}
+
+template <size_t SIZE, size_t ALIGN>
+void relocate_n(any<SIZE, ALIGN>* src, size_t count, any<SIZE, ALIGN>* dst) noexcept
+{
+    if (count)
+    {
+        internal::_any::_relocate_n(src, sizeof(any<SIZE, ALIGN>), count, dst, sizeof(any<SIZE, ALIGN>));
+    }
+}
+
 namespace internal
 {
+template <size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class _unique_any : public _any
+{
+private:
+    alignas(ALIGN) char _buffer[SIZE]{};
+
+public:
+    constexpr _unique_any(void) noexcept : _any(_buffer, SIZE, ALIGN) {}
+
+    _unique_any(const _unique_any&) = delete;
+
+    _unique_any(_unique_any&& rhs) noexcept : _any(_buffer, SIZE, ALIGN) { move_data(::lib::move(rhs)); }
+
+    template <class T, disable_if_t<is_same<_unique_any, decay_t<T>>::value>* = nullptr>
+    explicit _unique_any(T&& data) : _any(_buffer, SIZE, ALIGN)
+    {
+        emplace<decay_t<T>>(::lib::forward<T>(data));
+    }
+
+    _unique_any& operator=(const _unique_any&) = delete;
+
+    _unique_any& operator=(_unique_any&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            move_data(::lib::move(rhs));
+        }
+        return (*this);
+    }
+
+    template <class T, class... Args>
+    decay_t<T>& emplace(Args&&... args)
+    {
+        static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
+        static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
+        static_assert(is_nothrow_move_constructible<decay_t<T>>::value, "T must be nothrow move constructible");
+        _record_capacity<decay_t<T>, SIZE, ALIGN, _unique_any_manager>();
+        return (_emplace<decay_t<T>, _unique_any_manager>(::lib::forward<Args>(args)...));
+    }
+};
+
 
 template <class>
 class _function;
@@ -297,31 +1014,76 @@ template <class R, class... Args>
 class _function<R(Args...)>
 {
 protected:
-    using func_type    = R (*)(_any&, Args&&...);
-    func_type _derived = nullptr;
+    using direct_type = R (*)(Args...);
 
-private:
-    _any* const _pfunc;
+    union _callee
+    {
+        _any*       object;
+        direct_type function;
+
+        constexpr _callee(void) noexcept : object(nullptr) {}
+        constexpr _callee(_any* value) noexcept : object(value) {}
+        constexpr _callee(direct_type value) noexcept : function(value) {}
+    };
+
+    using func_type = R (*)(_callee, Args&&...);
+
+    func_type _derived = nullptr;
+    _callee   _target;
 
 public:
-    _function(_any* pfunc, func_type derived) noexcept : _pfunc(pfunc), _derived(derived) {}
+    constexpr _function(func_type derived, _callee target = _callee()) noexcept : _derived(derived), _target(target)
+    {}
 
-    _function& operator=(nullptr_t)
+    _function& operator=(nullptr_t) noexcept
     {
-        _pfunc->reset();
         _derived = nullptr;
         return (*this);
     }
 
-    R operator()(Args&&... args) { return (_derived(*_pfunc, forward<Args>(args)...)); }
+    R operator()(Args&&... args) const { return (_derived(_target, ::lib::forward<Args>(args)...)); }
 
     explicit operator bool(void) const noexcept { return (_derived); }
 
 protected:
+    struct direct_tag
+    {};
+    struct stateless_tag
+    {};
+    struct stored_tag
+    {};
+
+    template <class F>
+    using callable_tag = conditional_t<
+        is_convertible<decay_t<F>, direct_type>::value, direct_tag,
+        conditional_t<conjunction<is_empty<decay_t<F>>, is_trivially_copyable<decay_t<F>>,
+                                  is_trivially_default_constructible<decay_t<F>>>::value,
+                      stateless_tag, stored_tag>>;
+
+    template <class F, class Tag>
+    using enable_if_tag_t = enable_if_t<is_same<callable_tag<F>, Tag>::value>;
+
+    static R _invoke_direct(_callee callee, Args&&... args)
+    {
+        return (callee.function(::lib::forward<Args>(args)...));
+    }
+
+    template <class T>
+    static R _invoke(_callee callee, Args&&... args)
+    {
+        return ((*callee.object->template _cast<decay_t<T>>())(::lib::forward<Args>(args)...));
+    }
+
     template <class T>
-    static R _invoke(_any& func, Args&&... args)
+    static R _invoke_stateless(_callee, Args&&... args)
     {
-        return (any_cast<decay_t<T>>(func)(forward<Args>(args)...));
+        return (decay_t<T>{}(::lib::forward<Args>(args)...));
+    }
+
+    template <class T>
+    static R _invoke_unique(_callee callee, Args&&... args)
+    {
+        return ((*callee.object->template _cast<decay_t<T>, _unique_any_manager>())(::lib::forward<Args>(args)...));
     }
 };
 }
@@ -335,40 +1097,62 @@ class function<R(Args...), SIZE, ALIGN> : public internal::_function<R(Args...)>
     using base = internal::_function<R(Args...)>;
 
 private:
-    using any = any<SIZE, ALIGN>;
-    any _func;
+    using any_type = ::lib::any<SIZE, ALIGN>;
+    any_type _func;
 
 public:
-    function(void) noexcept : base(&_func, nullptr) {}
-    function(nullptr_t) noexcept : base(&_func, nullptr) {}
-    function(const function& rhs) : base(&_func, rhs._derived), _func(rhs._func) {}
-    function(function&& rhs) : base(&_func, rhs._derived), _func(rhs._func) { rhs = nullptr; }
-    template <class F, disable_if_t<is_same<function, remove_cvref_t<F>>::value>* = nullptr>
-    function(F&& func) : base(&_func, &base::template _invoke<F>), _func(move(func))
+    constexpr function(void) noexcept : base(nullptr) {}
+    constexpr function(nullptr_t) noexcept : base(nullptr) {}
+    function(const function& rhs) : base(rhs._derived, _target_of(rhs)), _func(rhs._func) {}
+    function(function&& rhs) : base(rhs._derived, _target_of(rhs)), _func(::lib::move(rhs._func))
+    {
+        rhs = nullptr;
+    }
+    template <size_t RHS_ALIGN>
+    constexpr function(const function<R(Args...), 0, RHS_ALIGN>& rhs) noexcept : base(rhs)
+    {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::direct_tag>* = nullptr>
+    constexpr function(F&& func) noexcept :
+        base(&base::_invoke_direct, static_cast<typename base::direct_type>(::lib::forward<F>(func)))
     {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::stateless_tag>* = nullptr>
+    constexpr function(F&&) noexcept : base(&base::template _invoke_stateless<F>)
+    {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::stored_tag>* = nullptr,
+              disable_if_t<is_same<function, remove_cvref_t<F>>::value>* = nullptr>
+    function(F&& func) : base(nullptr)
+    {
+        _assign(::lib::forward<F>(func), typename base::stored_tag{});
+    }
 
     function& operator=(const function& rhs)
     {
+        this->_target  = _target_of(rhs);
         _func          = rhs._func;
         this->_derived = rhs._derived;
         return (*this);
     }
     function& operator=(function&& rhs)
     {
-        *this = static_cast<const function&>(rhs);
-        rhs   = nullptr;
+        if (this != &rhs)
+        {
+            this->_target  = _target_of(rhs);
+            _func          = ::lib::move(rhs._func);
+            this->_derived = rhs._derived;
+            rhs            = nullptr;
+        }
         return (*this);
     }
     template <class F, disable_if_t<is_same<function, remove_cvref_t<F>>::value>* = nullptr>
     function& operator=(F&& func)
     {
-        _func          = move(func);
-        this->_derived = &base::template _invoke<F>;
+        _assign(::lib::forward<F>(func), typename base::template callable_tag<F>{});
         return (*this);
     }
 
     function& operator=(nullptr_t)
     {
+        _func.reset();
         base::operator=(nullptr);
         return (*this);
     }
@@ -393,9 +1177,79 @@ public:
             function* const src = *this ? this : &rhs;
             function* const dst = *this ? &rhs : this;
 
-            *dst = move(*src);
+            *dst = ::lib::move(*src);
         }
     }
+
+private:
+    typename base::_callee _target_of(const function& rhs) noexcept
+    {
+        return (rhs._func.has_value() ? typename base::_callee{&_func} : rhs._target);
+    }
+
+    template <class F>
+    void _assign(F&& func, typename base::direct_tag)
+    {
+        _func.reset();
+        this->_target  = static_cast<typename base::direct_type>(::lib::forward<F>(func));
+        this->_derived = &base::_invoke_direct;
+    }
+
+    template <class F>
+    void _assign(F&&, typename base::stateless_tag)
+    {
+        _func.reset();
+        this->_derived = &base::template _invoke_stateless<F>;
+    }
+
+    template <class F>
+    void _assign(F&& func, typename base::stored_tag)
+    {
+        _func          = ::lib::forward<F>(func);
+        this->_target  = &_func;
+        this->_derived = &base::template _invoke<F>;
+    }
+};
+
+template <class R, class... Args, size_t ALIGN>
+class function<R(Args...), 0, ALIGN> : public internal::_function<R(Args...)>
+{
+    using base = internal::_function<R(Args...)>;
+
+public:
+    constexpr function(void) noexcept : base(nullptr) {}
+    constexpr function(nullptr_t) noexcept : base(nullptr) {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::direct_tag>* = nullptr>
+    constexpr function(F&& func) noexcept :
+        base(&base::_invoke_direct, static_cast<typename base::direct_type>(::lib::forward<F>(func)))
+    {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::stateless_tag>* = nullptr>
+    constexpr function(F&&) noexcept : base(&base::template _invoke_stateless<F>)
+    {}
+    template <class F, typename base::template enable_if_tag_t<F, typename base::stored_tag>* = nullptr,
+              disable_if_t<is_same<function, remove_cvref_t<F>>::value>* = nullptr>
+    function(F&&)
+    {
+        static_assert(!is_same<F, F>::value, "function without storage accepts only pointers and empty callables");
+    }
+
+    function& operator=(nullptr_t) noexcept
+    {
+        base::operator=(nullptr);
+        return (*this);
+    }
+    template <class F, disable_if_t<is_same<function, remove_cvref_t<F>>::value>* = nullptr>
+    function& operator=(F&& func) noexcept
+    {
+        return (*this = function{::lib::forward<F>(func)});
+    }
+
+    void swap(function& rhs) noexcept
+    {
+        const function tmp{rhs};
+        rhs   = *this;
+        *this = tmp;
+    }
 };
 
 template <class R, class... Args, size_t SIZE, size_t ALIGN>
@@ -404,6 +1258,125 @@ void swap(function<R(Args...), SIZE, ALIGN>& lhs, function<R(Args...), SIZE, ALI
     lhs.swap(rhs);
 }
 
+template <class, size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class unique_function;
+
+template <class R, class... Args, size_t SIZE, size_t ALIGN>
+class unique_function<R(Args...), SIZE, ALIGN> : public internal::_function<R(Args...)>
+{
+    using base = internal::_function<R(Args...)>;
+
+private:
+    internal::_unique_any<SIZE, ALIGN> _func;
+
+public:
+    unique_function(void) noexcept : base(nullptr, &_func) {}
+    unique_function(nullptr_t) noexcept : base(nullptr, &_func) {}
+    unique_function(const unique_function&) = delete;
+    unique_function(unique_function&& rhs) noexcept : base(rhs._derived, &_func), _func(::lib::move(rhs._func))
+    {
+        rhs._derived = nullptr;
+    }
+    template <class F, disable_if_t<is_same<unique_function, remove_cvref_t<F>>::value>* = nullptr>
+    unique_function(F&& func) : base(&base::template _invoke_unique<F>, &_func), _func(::lib::forward<F>(func))
+    {}
+
+    unique_function& operator=(const unique_function&) = delete;
+    unique_function& operator=(unique_function&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            _func          = ::lib::move(rhs._func);
+            this->_derived = rhs._derived;
+            rhs._derived   = nullptr;
+        }
+        return (*this);
+    }
+    template <class F, disable_if_t<is_same<unique_function, remove_cvref_t<F>>::value>* = nullptr>
+    unique_function& operator=(F&& func)
+    {
+        _func.template emplace<F>(::lib::forward<F>(func));
+        this->_derived = &base::template _invoke_unique<F>;
+        return (*this);
+    }
+
+    unique_function& operator=(nullptr_t) noexcept
+    {
+        _func.reset();
+        base::operator=(nullptr);
+        return (*this);
+    }
+
+    void swap(unique_function& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            unique_function tmp{::lib::move(rhs)};
+            rhs   = ::lib::move(*this);
+            *this = ::lib::move(tmp);
+        }
+    }
+};
+
+template <class R, class... Args, size_t SIZE, size_t ALIGN>
+void swap(unique_function<R(Args...), SIZE, ALIGN>& lhs, unique_function<R(Args...), SIZE, ALIGN>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <class>
+class function_ref;
+
+template <class R, class... Args>
+class function_ref<R(Args...)>
+{
+private:
+    union _storage
+    {
+        void* object;
+        void (*function)(void);
+    };
+    using thunk_type = R (*)(_storage, Args...);
+
+    _storage   _callee;
+    thunk_type _thunk;
+
+    template <class F>
+    using is_function_pointer = is_function<remove_pointer_t<decay_t<F>>>;
+
+public:
+    template <class F, enable_if_t<conjunction<negation<is_same<function_ref, remove_cvref_t<F>>>,
+                                               negation<is_function_pointer<F>>>::value>* = nullptr>
+    function_ref(F&& func) noexcept : _thunk(&_invoke_object<remove_reference_t<F>>)
+    {
+        _callee.object = const_cast<void*>(static_cast<const volatile void*>(&func));
+    }
+
+    template <class F, enable_if_t<is_function_pointer<F>::value>* = nullptr>
+    function_ref(F&& func) noexcept : _thunk(&_invoke_function<decay_t<F>>)
+    {
+        _callee.function = reinterpret_cast<void (*)(void)>(static_cast<decay_t<F>>(func));
+    }
+
+    function_ref(const function_ref&) noexcept = default;
+    function_ref& operator=(const function_ref&) noexcept = default;
+
+    R operator()(Args... args) const { return (_thunk(_callee, ::lib::forward<Args>(args)...)); }
+
+private:
+    template <class F>
+    static R _invoke_object(_storage callee, Args... args)
+    {
+        return ((*static_cast<F*>(callee.object))(::lib::forward<Args>(args)...));
+    }
+
+    template <class F>
+    static R _invoke_function(_storage callee, Args... args)
+    {
+        return (reinterpret_cast<F>(callee.function)(::lib::forward<Args>(args)...));
+    }
+};
+
 template <class... Args>
 struct fitted_any
 {
@@ -413,18 +1386,20 @@ struct fitted_any
     using type = any<SIZE, ALIGN>;
     template <class Func>
     using invoker_type = function<Func, SIZE, ALIGN>;
+    template <class Func>
+    using unique_invoker_type = unique_function<Func, SIZE, ALIGN>;
 };
 
 template <size_t SIZE, size_t ALIGN, class T, class... Args>
 any<SIZE, ALIGN> make_any(Args&&... args)
 {
-    return (any<SIZE, ALIGN>(in_place_type_v<T>::value, forward<Args>(args)...));
+    return (any<SIZE, ALIGN>(in_place_type_v<T>::value, ::lib::forward<Args>(args)...));
 }
 
 template <class T, class... Args>
 typename fitted_any<T>::type make_fitted_any(Args&&... args)
 {
-    return (typename fitted_any<T>::type(in_place_type_v<T>::value, forward<Args>(args)...));
+    return (typename fitted_any<T>::type(in_place_type_v<T>::value, ::lib::forward<Args>(args)...));
 }
 
 }
\ No newline at end of file
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "type_traits.h"
+#include "new.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace lib
+{
+namespace internal
+{
+[[noreturn]] inline void _arena_exhausted(void) noexcept
+{
+#ifdef _MSC_VER
+    __fastfail(7);
+#else
+    __builtin_trap();
+#endif
+}
+}
+
+class monotonic_arena
+{
+private:
+    struct chunk
+    {
+        chunk* next;
+    };
+
+    char* const  _initial;
+    char* const  _initial_end;
+    const size_t _chunk_size;
+    char*        _current;
+    char*        _end;
+    chunk*       _chunks = nullptr;
+    size_t       _used   = 0;
+
+public:
+    explicit monotonic_arena(size_t chunk_size = 64 * 1024) noexcept : monotonic_arena(nullptr, 0, chunk_size) {}
+
+    monotonic_arena(void* buffer, size_t size, size_t chunk_size = 0) noexcept :
+        _initial(static_cast<char*>(buffer)), _initial_end(static_cast<char*>(buffer) + size),
+        _chunk_size(chunk_size), _current(_initial), _end(_initial_end)
+    {}
+
+    monotonic_arena(const monotonic_arena&) = delete;
+    monotonic_arena& operator=(const monotonic_arena&) = delete;
+
+    ~monotonic_arena(void) { release(); }
+
+    void* allocate(size_t size, size_t align)
+    {
+        const uintptr_t current = reinterpret_cast<uintptr_t>(_current);
+        const uintptr_t aligned = (current + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        const uintptr_t end     = reinterpret_cast<uintptr_t>(_end);
+        if (aligned < current || aligned > end || size > end - aligned)
+        {
+            return (_grow(size, align));
+        }
+        _current = reinterpret_cast<char*>(aligned + size);
+        _used += size;
+        return (reinterpret_cast<void*>(aligned));
+    }
+
+    void deallocate(void*, size_t, size_t) noexcept {}
+
+    void release(void) noexcept
+    {
+        while (_chunks)
+        {
+            chunk* const next = _chunks->next;
+            ::operator delete(_chunks);
+            _chunks = next;
+        }
+        _current = _initial;
+        _end     = _initial_end;
+        _used    = 0;
+    }
+
+    size_t used(void) const noexcept { return (_used); }
+
+private:
+    void* _grow(size_t size, size_t align)
+    {
+        constexpr size_t header = (sizeof(chunk) + alignof(max_align_t) - 1) / alignof(max_align_t) *
+                                  alignof(max_align_t);
+        if (!_chunk_size || align > ~size_t(0) - header || size > ~size_t(0) - header - align)
+        {
+            internal::_arena_exhausted();
+        }
+        const size_t required = size + align;
+        const size_t capacity = (required > _chunk_size) ? required : _chunk_size;
+        auto* const  block    = static_cast<chunk*>(::operator new(header + capacity));
+        block->next           = _chunks;
+        _chunks               = block;
+        _current              = reinterpret_cast<char*>(block) + header;
+        _end                  = _current + capacity;
+        return (allocate(size, align));
+    }
+};
+}
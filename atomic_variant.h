@@ -0,0 +1,431 @@
+#pragma once
+
+#include "any.h"
+#include "variant.h"
+#include "task_queue.h"
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#define LIB_HAS_CAS16 1
+#elif defined(__GCC_HAVE_SYNC_COMPARE_AND_SWAP_16)
+#define LIB_HAS_CAS16 1
+#else
+#define LIB_HAS_CAS16 0
+#endif
+
+#if LIB_HAS_CAS16 && defined(__AVX__) && (defined(_M_X64) || defined(__x86_64__))
+#include <immintrin.h>
+#define LIB_HAS_LOAD16 1
+#else
+#define LIB_HAS_LOAD16 0
+#endif
+
+namespace lib
+{
+namespace internal
+{
+template <size_t N>
+class _atomic_word
+{
+    static_assert(N <= sizeof(unsigned long long), "Insufficient size");
+
+private:
+    std::atomic<unsigned long long> _value{0};
+
+public:
+    static constexpr bool is_lock_free = true;
+
+    void load(void* dst) const noexcept
+    {
+        const unsigned long long value = _value.load(std::memory_order_acquire);
+        std::memcpy(dst, &value, N);
+    }
+
+    void store(const void* src) noexcept { _value.store(_word(src), std::memory_order_release); }
+
+    bool compare_exchange(void* expected, const void* desired) noexcept
+    {
+        unsigned long long value = _word(expected);
+        if (_value.compare_exchange_strong(value, _word(desired), std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+        {
+            return (true);
+        }
+        std::memcpy(expected, &value, N);
+        return (false);
+    }
+
+private:
+    static unsigned long long _word(const void* src) noexcept
+    {
+        unsigned long long value = 0;
+        std::memcpy(&value, src, N);
+        return (value);
+    }
+};
+
+#if LIB_HAS_CAS16
+template <size_t N>
+class _atomic_double_word
+{
+    static_assert(N <= 16, "Insufficient size");
+
+private:
+    struct alignas(16) pair
+    {
+        long long low;
+        long long high;
+    };
+
+    mutable pair _value{0, 0};
+
+public:
+    static constexpr bool is_lock_free = true;
+
+    void load(void* dst) const noexcept
+    {
+#if LIB_HAS_LOAD16
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+        const __m128i value = _mm_load_si128(reinterpret_cast<const __m128i*>(&_value));
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+#else
+        pair value{0, 0};
+        _cas(value, value);
+#endif
+        std::memcpy(dst, &value, N);
+    }
+
+    void store(const void* src) noexcept
+    {
+        const pair desired = _pair(src);
+        pair       value{0, 0};
+        while (!_cas(value, desired))
+        {
+        }
+    }
+
+    bool compare_exchange(void* expected, const void* desired) noexcept
+    {
+        pair value = _pair(expected);
+        if (_cas(value, _pair(desired)))
+        {
+            return (true);
+        }
+        std::memcpy(expected, &value, N);
+        return (false);
+    }
+
+private:
+    static pair _pair(const void* src) noexcept
+    {
+        pair value{0, 0};
+        std::memcpy(&value, src, N);
+        return (value);
+    }
+
+    bool _cas(pair& expected, const pair& desired) const noexcept
+    {
+#ifdef _MSC_VER
+        return (_InterlockedCompareExchange128(&_value.low, desired.high, desired.low, &expected.low) != 0);
+#else
+        unsigned __int128 compare;
+        unsigned __int128 exchange;
+        std::memcpy(&compare, &expected, sizeof(compare));
+        std::memcpy(&exchange, &desired, sizeof(exchange));
+        const unsigned __int128 previous =
+            __sync_val_compare_and_swap(reinterpret_cast<unsigned __int128*>(&_value), compare, exchange);
+        std::memcpy(&expected, &previous, sizeof(previous));
+        return (previous == compare);
+#endif
+    }
+};
+#endif
+
+template <size_t N>
+class _seqlock
+{
+private:
+    static constexpr size_t WORDS = (N + sizeof(size_t) - 1) / sizeof(size_t);
+
+    alignas(_cache_line_size) std::atomic<size_t> _sequence{0};
+    std::atomic<size_t> _words[WORDS];
+
+public:
+    static constexpr bool is_lock_free = false;
+
+    _seqlock(void) noexcept
+    {
+        for (auto& word : _words)
+        {
+            word.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void load(void* dst) const noexcept
+    {
+        size_t buffer[WORDS];
+        for (;;)
+        {
+            const size_t sequence = _sequence.load(std::memory_order_acquire);
+            if (!(sequence & 1))
+            {
+                for (size_t i = 0; i < WORDS; ++i)
+                {
+                    buffer[i] = _words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (_sequence.load(std::memory_order_relaxed) == sequence)
+                {
+                    break;
+                }
+            }
+            std::this_thread::yield();
+        }
+        std::memcpy(dst, buffer, N);
+    }
+
+    void store(const void* src) noexcept
+    {
+        const size_t sequence = _lock();
+        _write(src);
+        _sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool compare_exchange(void* expected, const void* desired) noexcept
+    {
+        const size_t sequence = _lock();
+        size_t       buffer[WORDS];
+        for (size_t i = 0; i < WORDS; ++i)
+        {
+            buffer[i] = _words[i].load(std::memory_order_relaxed);
+        }
+        const bool equal = std::memcmp(buffer, expected, N) == 0;
+        if (equal)
+        {
+            _write(desired);
+        }
+        else
+        {
+            std::memcpy(expected, buffer, N);
+        }
+        _sequence.store(sequence + 2, std::memory_order_release);
+        return (equal);
+    }
+
+private:
+    size_t _lock(void) noexcept
+    {
+        size_t sequence = _sequence.load(std::memory_order_relaxed);
+        while ((sequence & 1) || !_sequence.compare_exchange_weak(sequence, sequence + 1, std::memory_order_acquire,
+                                                                  std::memory_order_relaxed))
+        {
+            std::this_thread::yield();
+            sequence = _sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return (sequence);
+    }
+
+    void _write(const void* src) noexcept
+    {
+        size_t buffer[WORDS] = {};
+        std::memcpy(buffer, src, N);
+        for (size_t i = 0; i < WORDS; ++i)
+        {
+            _words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+    }
+};
+
+// Payloads of up to 16 bytes are lock-free wherever a 16-byte compare-exchange exists (MSVC on x64, GCC and
+// Clang with -mcx16 or on targets that provide it natively). Readers compare-exchange the value against itself,
+// which takes the cache line exclusive; with AVX an aligned 16-byte load is atomic and is used instead.
+// Larger payloads, and 9-16 byte payloads without the instruction, use the seqlock.
+template <size_t N>
+using _atomic_bytes = conditional_t<(N <= 8), _atomic_word<N>,
+#if LIB_HAS_CAS16
+                                    conditional_t<(N <= 16), _atomic_double_word<N>, _seqlock<N>>
+#else
+                                    _seqlock<N>
+#endif
+                                    >;
+}
+
+template <class... Ts>
+class atomic_variant
+{
+    static_assert(conjunction<is_trivially_copyable<Ts>...>::value, "T params must be trivially copyable.");
+    static_assert(sizeof...(Ts) < 256, "Too many T params.");
+
+public:
+    using value_type = variant<Ts...>;
+
+private:
+    struct packed
+    {
+        unsigned char payload[largest<Ts...>::SIZE];
+        unsigned char index;
+    };
+
+    internal::_atomic_bytes<sizeof(packed)> _storage;
+
+public:
+    static constexpr bool is_always_lock_free = internal::_atomic_bytes<sizeof(packed)>::is_lock_free;
+
+    atomic_variant(void) noexcept { store(value_type{}); }
+    explicit atomic_variant(const value_type& value) noexcept { store(value); }
+    atomic_variant(const atomic_variant&) = delete;
+    atomic_variant& operator=(const atomic_variant&) = delete;
+
+    bool is_lock_free(void) const noexcept { return (is_always_lock_free); }
+
+    value_type load(void) const noexcept
+    {
+        packed current;
+        _storage.load(&current);
+        return (_unpack(current));
+    }
+
+    void store(const value_type& value) noexcept
+    {
+        const packed desired = _pack(value);
+        _storage.store(&desired);
+    }
+
+    bool compare_exchange_strong(value_type& expected, const value_type& desired) noexcept
+    {
+        packed       current = _pack(expected);
+        const packed next    = _pack(desired);
+        if (_storage.compare_exchange(&current, &next))
+        {
+            return (true);
+        }
+        expected = _unpack(current);
+        return (false);
+    }
+
+    operator value_type(void) const noexcept { return (load()); }
+
+private:
+    static constexpr size_t _sizes[] = {sizeof(Ts)...};
+
+    static packed _pack(const value_type& value) noexcept
+    {
+        packed result;
+        std::memset(&result, 0, sizeof(result));
+        std::memcpy(result.payload, value._get_buffer(), _sizes[value.index()]);
+        result.index = static_cast<unsigned char>(value.index());
+        return (result);
+    }
+
+    static value_type _unpack(const packed& current) noexcept
+    {
+        value_type result;
+        result._construct_with(current.index, [&current](void* dst) {
+            std::memcpy(dst, current.payload, _sizes[current.index]);
+            return (true);
+        });
+        return (result);
+    }
+};
+
+template <class... Ts>
+constexpr size_t atomic_variant<Ts...>::_sizes[];
+
+template <size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class atomic_any
+{
+public:
+    using value_type = any<SIZE, ALIGN>;
+
+private:
+    struct packed
+    {
+        unsigned char               payload[SIZE];
+        internal::_any_invoker_type invoker;
+    };
+
+    internal::_atomic_bytes<sizeof(packed)> _storage;
+
+public:
+    static constexpr bool is_always_lock_free = internal::_atomic_bytes<sizeof(packed)>::is_lock_free;
+
+    atomic_any(void) noexcept { reset(); }
+    atomic_any(const atomic_any&) = delete;
+    atomic_any& operator=(const atomic_any&) = delete;
+
+    bool is_lock_free(void) const noexcept { return (is_always_lock_free); }
+
+    value_type load(void) const noexcept
+    {
+        packed current;
+        _storage.load(&current);
+        value_type result;
+        result._construct_raw(current.invoker, [&current](void* dst) {
+            std::memcpy(dst, current.payload, SIZE);
+            return (true);
+        });
+        return (result);
+    }
+
+    template <class T>
+    bool load(T& value) const noexcept
+    {
+        packed current;
+        _storage.load(&current);
+        if (current.invoker != internal::_any_manager<T>::invoke)
+        {
+            return (false);
+        }
+        std::memcpy(&value, current.payload, sizeof(T));
+        return (true);
+    }
+
+    template <class T>
+    void store(const T& value) noexcept
+    {
+        const packed desired = _pack(value);
+        _storage.store(&desired);
+    }
+
+    void reset(void) noexcept
+    {
+        packed desired;
+        std::memset(&desired, 0, sizeof(desired));
+        _storage.store(&desired);
+    }
+
+    template <class T>
+    bool compare_exchange_strong(T& expected, const T& desired) noexcept
+    {
+        packed       current = _pack(expected);
+        const packed next    = _pack(desired);
+        if (_storage.compare_exchange(&current, &next))
+        {
+            return (true);
+        }
+        if (current.invoker == internal::_any_manager<T>::invoke)
+        {
+            std::memcpy(&expected, current.payload, sizeof(T));
+        }
+        return (false);
+    }
+
+private:
+    template <class T>
+    static packed _pack(const T& value) noexcept
+    {
+        static_assert(is_trivially_copyable<T>::value, "T must be trivially copyable.");
+        static_assert(sizeof(T) <= SIZE, "Insufficient size");
+        static_assert(ALIGN % alignof(T) == 0, "Alignment is incorrect");
+        packed result;
+        std::memset(&result, 0, sizeof(result));
+        std::memcpy(result.payload, &value, sizeof(T));
+        result.invoker = internal::_any_manager<T>::invoke;
+        return (result);
+    }
+};
+}
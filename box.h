@@ -0,0 +1,182 @@
+#pragma once
+
+#include "arena.h"
+#include "hash.h"
+
+namespace lib
+{
+namespace internal
+{
+template <bool ArenaOwned, class T, class Arena>
+class _box_base
+{
+protected:
+    Arena* _arena;
+    T*     _value;
+
+    constexpr _box_base(Arena* arena, T* value) noexcept : _arena(arena), _value(value) {}
+
+    void _destroy(void) noexcept { _value = nullptr; }
+};
+
+template <class T, class Arena>
+class _box_base<false, T, Arena>
+{
+protected:
+    Arena* _arena;
+    T*     _value;
+
+    constexpr _box_base(Arena* arena, T* value) noexcept : _arena(arena), _value(value) {}
+
+    ~_box_base(void) { _destroy(); }
+
+    void _destroy(void) noexcept
+    {
+        if (_value)
+        {
+            _value->~T();
+            _arena->deallocate(_value, sizeof(T), alignof(T));
+            _value = nullptr;
+        }
+    }
+};
+}
+
+template <class T, class Arena = monotonic_arena, bool ArenaOwned = false>
+class box : private internal::_box_base<ArenaOwned, T, Arena>
+{
+private:
+    using base = internal::_box_base<ArenaOwned, T, Arena>;
+    using base::_arena;
+    using base::_value;
+    using base::_destroy;
+
+public:
+    template <class... Args>
+    explicit box(Arena& arena, Args&&... args) : base(&arena, _create(arena, ::lib::forward<Args>(args)...)) {}
+
+    box(const box& rhs) : base(rhs._arena, rhs._value ? _create(*rhs._arena, *rhs._value) : nullptr) {}
+
+    box(box&& rhs) noexcept : base(rhs._arena, rhs._value) { rhs._value = nullptr; }
+
+    box& operator=(const box& rhs)
+    {
+        if (this != &rhs)
+        {
+            if (_value && rhs._value)
+            {
+                *_value = *rhs._value;
+            }
+            else
+            {
+                *this = box{rhs};
+            }
+        }
+        return (*this);
+    }
+
+    box& operator=(box&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            _destroy();
+            _arena     = rhs._arena;
+            _value     = rhs._value;
+            rhs._value = nullptr;
+        }
+        return (*this);
+    }
+
+    bool valueless_after_move(void) const noexcept { return (!_value); }
+
+    Arena& arena(void) const noexcept { return (*_arena); }
+
+    T*       get(void) noexcept { return (_value); }
+    const T* get(void) const noexcept { return (_value); }
+
+    T&       operator*(void) noexcept { return (*_value); }
+    const T& operator*(void) const noexcept { return (*_value); }
+    T*       operator->(void) noexcept { return (_value); }
+    const T* operator->(void) const noexcept { return (_value); }
+
+private:
+    template <class... Args>
+    static T* _create(Arena& arena, Args&&... args)
+    {
+        static_assert(!ArenaOwned || is_trivially_destructible<T>::value, "Arena-owned box needs trivial destructor");
+        struct release
+        {
+            Arena& arena;
+            void*  memory;
+            ~release(void)
+            {
+                if (memory)
+                {
+                    arena.deallocate(memory, sizeof(T), alignof(T));
+                }
+            }
+        } releaser{arena, arena.allocate(sizeof(T), alignof(T))};
+        T* const value  = ::new (releaser.memory) T(::lib::forward<Args>(args)...);
+        releaser.memory = nullptr;
+        return (value);
+    }
+};
+
+// Skips every payload destructor and leaves the memory to the arena, so deep structures tear down without recursion.
+template <class T, class Arena = monotonic_arena>
+using arena_box = box<T, Arena, true>;
+
+template <class T, class Arena, class... Args>
+box<T, Arena> make_box(Arena& arena, Args&&... args)
+{
+    return (box<T, Arena>{arena, ::lib::forward<Args>(args)...});
+}
+
+template <class T, class Arena, class... Args>
+arena_box<T, Arena> make_arena_box(Arena& arena, Args&&... args)
+{
+    return (arena_box<T, Arena>{arena, ::lib::forward<Args>(args)...});
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator==(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (*lhs == *rhs);
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator!=(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (!(lhs == rhs));
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator<(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (*lhs < *rhs);
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator>(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (rhs < lhs);
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator<=(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (!(rhs < lhs));
+}
+
+template <class T, class Arena, bool ArenaOwned>
+bool operator>=(const box<T, Arena, ArenaOwned>& lhs, const box<T, Arena, ArenaOwned>& rhs)
+{
+    return (!(lhs < rhs));
+}
+
+template <class T, class Arena, bool ArenaOwned>
+struct hash<box<T, Arena, ArenaOwned>>
+{
+    size_t operator()(const box<T, Arena, ArenaOwned>& value) const { return (hash<T>{}(*value)); }
+};
+}
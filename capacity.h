@@ -0,0 +1,241 @@
+#pragma once
+
+#include "type_traits.h"
+#include "trace.h"
+#include <atomic>
+
+namespace lib
+{
+namespace internal
+{
+using _capacity_key = void (*)(void);
+
+struct _capacity_cache;
+}
+
+struct capacity_record
+{
+    const char*                   type_name;
+    size_t                        type_size;
+    size_t                        type_align;
+    size_t                        capacity;
+    size_t                        align;
+    internal::_capacity_key const key;
+    std::atomic<size_t>           emplaced{0};
+    std::atomic<ptrdiff_t>        live{0};
+    std::atomic<ptrdiff_t>        peak{0};
+    capacity_record*              next    = nullptr;
+    capacity_record*              sibling = nullptr;
+
+    capacity_record(const char* name, size_t size, size_t alignment, size_t buffer_size, size_t buffer_align,
+                    internal::_capacity_key record_key, internal::_capacity_cache& cache) noexcept;
+    capacity_record(const capacity_record&) = delete;
+    capacity_record& operator=(const capacity_record&) = delete;
+
+    size_t wasted(void) const noexcept { return (capacity - type_size); }
+};
+
+namespace internal
+{
+inline std::atomic<capacity_record*>& _capacity_head(void) noexcept
+{
+    static std::atomic<capacity_record*> head{nullptr};
+    return (head);
+}
+
+struct _capacity_cache
+{
+    std::atomic<capacity_record*> head{nullptr};
+    std::atomic<capacity_record*> last{nullptr};
+};
+
+template <class Manager>
+_capacity_cache& _capacity_cache_of(void) noexcept
+{
+    static _capacity_cache cache;
+    return (cache);
+}
+
+template <class Manager>
+capacity_record* _capacity_lookup(size_t capacity, size_t align) noexcept
+{
+    _capacity_cache& cache  = _capacity_cache_of<Manager>();
+    capacity_record* record = cache.last.load(std::memory_order_acquire);
+    if (record && record->capacity == capacity && record->align == align)
+    {
+        return (record);
+    }
+    for (record = cache.head.load(std::memory_order_acquire); record; record = record->sibling)
+    {
+        if (record->capacity == capacity && record->align == align)
+        {
+            cache.last.store(record, std::memory_order_release);
+            return (record);
+        }
+    }
+    return (nullptr);
+}
+
+struct _capacity_query
+{
+    size_t           capacity;
+    size_t           align;
+    capacity_record* record;
+};
+
+inline void _capacity_push(std::atomic<capacity_record*>& head, capacity_record* record,
+                           capacity_record* capacity_record::*link) noexcept
+{
+    capacity_record* top = head.load(std::memory_order_relaxed);
+    do
+    {
+        record->*link = top;
+    } while (!head.compare_exchange_weak(top, record, std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <class T, size_t SIZE, size_t ALIGN, size_t TYPE_SIZE, size_t TYPE_ALIGN>
+[[deprecated("capacity listing")]] constexpr bool _capacity_listing(void) noexcept
+{
+    return (true);
+}
+
+class _capacity_slot_disabled
+{
+protected:
+    constexpr _capacity_slot_disabled(size_t, size_t) noexcept {}
+
+    template <class T, size_t SIZE, size_t ALIGN, class Manager>
+    static void _capacity_record(void) noexcept
+    {}
+    template <class Lookup>
+    void _capacity_acquire(Lookup&&) noexcept
+    {}
+    void _capacity_release(void) noexcept {}
+};
+
+class _capacity_slot_enabled
+{
+private:
+    size_t           _capacity;
+    size_t           _align;
+    capacity_record* _record = nullptr;
+
+protected:
+    constexpr _capacity_slot_enabled(size_t capacity, size_t align) noexcept : _capacity(capacity), _align(align) {}
+
+    template <class T, size_t SIZE, size_t ALIGN, class Manager>
+    static void _capacity_record(void) noexcept
+    {
+        static capacity_record record{type_name<T>(),
+                                      sizeof(T),
+                                      alignof(T),
+                                      SIZE,
+                                      ALIGN,
+                                      reinterpret_cast<_capacity_key>(Manager::invoke),
+                                      _capacity_cache_of<Manager>()};
+        record.emplaced.fetch_add(1, std::memory_order_relaxed);
+    }
+    template <class Lookup>
+    void _capacity_acquire(Lookup&& lookup) noexcept
+    {
+        _record = lookup(_capacity, _align);
+        if (_record)
+        {
+            const ptrdiff_t live = _record->live.fetch_add(1, std::memory_order_relaxed) + 1;
+            ptrdiff_t       peak = _record->peak.load(std::memory_order_relaxed);
+            while (live > peak && !_record->peak.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+            {
+            }
+        }
+    }
+    void _capacity_release(void) noexcept
+    {
+        if (_record)
+        {
+            _record->live.fetch_sub(1, std::memory_order_relaxed);
+            _record = nullptr;
+        }
+    }
+};
+
+template <class T, size_t SIZE, size_t ALIGN>
+constexpr bool _capacity_list(void) noexcept
+{
+#ifdef LIB_CAPACITY_LISTING
+    return (_capacity_listing<T, SIZE, ALIGN, sizeof(T), alignof(T)>());
+#else
+    return (true);
+#endif
+}
+
+#ifdef LIB_ENABLE_CAPACITY_PROFILE
+using _capacity_slot = _capacity_slot_enabled;
+#else
+using _capacity_slot = _capacity_slot_disabled;
+#endif
+}
+
+inline capacity_record::capacity_record(const char* name, size_t size, size_t alignment, size_t buffer_size,
+                                        size_t buffer_align, internal::_capacity_key record_key,
+                                        internal::_capacity_cache& cache) noexcept :
+    type_name(name),
+    type_size(size),
+    type_align(alignment),
+    capacity(buffer_size),
+    align(buffer_align),
+    key(record_key)
+{
+    internal::_capacity_push(cache.head, this, &capacity_record::sibling);
+    internal::_capacity_push(internal::_capacity_head(), this, &capacity_record::next);
+}
+
+struct capacity_histogram
+{
+    static constexpr size_t bucket_count = sizeof(size_t) * 8 + 1;
+
+    size_t counts[bucket_count]{};
+
+    static constexpr size_t bucket_of(size_t wasted) noexcept
+    {
+        return (wasted ? bucket_of(wasted >> 1) + 1 : 0);
+    }
+    static constexpr size_t bucket_min(size_t bucket) noexcept { return (bucket ? size_t(1) << (bucket - 1) : 0); }
+};
+
+template <class Func>
+void for_each_capacity_record(Func&& func)
+{
+    for (const auto* record = internal::_capacity_head().load(std::memory_order_acquire); record;
+         record = record->next)
+    {
+        func(*record);
+    }
+}
+
+inline size_t live_wasted_bytes(void) noexcept
+{
+    size_t total = 0;
+    for (const auto* record = internal::_capacity_head().load(std::memory_order_acquire); record;
+         record = record->next)
+    {
+        const ptrdiff_t live = record->live.load(std::memory_order_relaxed);
+        total += (live > 0 ? static_cast<size_t>(live) : 0) * record->wasted();
+    }
+    return (total);
+}
+
+inline capacity_histogram make_capacity_histogram(void) noexcept
+{
+    capacity_histogram histogram;
+    for (const auto* record = internal::_capacity_head().load(std::memory_order_acquire); record;
+         record = record->next)
+    {
+        const ptrdiff_t live = record->live.load(std::memory_order_relaxed);
+        if (live > 0)
+        {
+            histogram.counts[capacity_histogram::bucket_of(record->wasted())] += static_cast<size_t>(live);
+        }
+    }
+    return (histogram);
+}
+}
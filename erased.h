@@ -0,0 +1,220 @@
+#pragma once
+
+#include "any.h"
+
+#define LIB_ERASED_METHOD(tag, member)                                                             \
+    struct tag                                                                                     \
+    {                                                                                              \
+        template <class T, class R, class... Args>                                                 \
+        static R invoke(void* self, Args... args)                                                  \
+        {                                                                                          \
+            return (static_cast<R>(static_cast<T*>(self)->member(::lib::forward<Args>(args)...))); \
+        }                                                                                          \
+    }
+
+namespace lib
+{
+template <class Tag, class Signature>
+struct method;
+
+template <class... Methods>
+struct interface
+{};
+
+namespace internal
+{
+template <class Method>
+struct _vtable_entry;
+
+template <class Tag, class R, class... Args>
+struct _vtable_entry<method<Tag, R(Args...)>>
+{
+    using func_type = R (*)(void*, Args...);
+    func_type func;
+
+    template <class T>
+    static constexpr func_type thunk(void) noexcept
+    {
+        return (&Tag::template invoke<T, R, Args...>);
+    }
+};
+
+template <class Tag, class R, class... Args>
+struct _vtable_entry<method<Tag, R(Args...) const>>
+{
+    using func_type = R (*)(void*, Args...);
+    func_type func;
+
+    template <class T>
+    static constexpr func_type thunk(void) noexcept
+    {
+        return (&Tag::template invoke<const T, R, Args...>);
+    }
+};
+
+template <class Interface>
+struct _vtable;
+
+template <class... Methods>
+struct _vtable<interface<Methods...>> : _vtable_entry<Methods>...
+{
+    _any_invoker_type manage;
+
+    constexpr _vtable(_any_invoker_type manager, typename _vtable_entry<Methods>::func_type... funcs) noexcept :
+        _vtable_entry<Methods>{funcs}..., manage(manager)
+    {}
+};
+
+template <class Interface, class T>
+struct _vtable_for;
+
+template <class... Methods, class T>
+struct _vtable_for<interface<Methods...>, T>
+{
+    static constexpr _vtable<interface<Methods...>> value{&_any_manager<T>::invoke,
+                                                          _vtable_entry<Methods>::template thunk<T>()...};
+};
+
+template <class... Methods, class T>
+constexpr _vtable<interface<Methods...>> _vtable_for<interface<Methods...>, T>::value;
+
+template <class Tag, class R, class... Args, class... Ts>
+R _dispatch(const _vtable_entry<method<Tag, R(Args...)>>& entry, void* self, Ts&&... args)
+{
+    return (entry.func(self, ::lib::forward<Ts>(args)...));
+}
+
+template <class Tag, class R, class... Args, class... Ts>
+R _dispatch(const _vtable_entry<method<Tag, R(Args...) const>>& entry, void* self, Ts&&... args)
+{
+    return (entry.func(self, ::lib::forward<Ts>(args)...));
+}
+
+template <class Tag, class R, class... Args, class... Ts>
+R _dispatch_const(const _vtable_entry<method<Tag, R(Args...) const>>& entry, const void* self, Ts&&... args)
+{
+    return (entry.func(const_cast<void*>(self), ::lib::forward<Ts>(args)...));
+}
+}
+
+template <class Interface, size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class erased
+{
+private:
+    alignas(ALIGN) char _buffer[SIZE]{};
+    const internal::_vtable<Interface>* _vtable = nullptr;
+
+public:
+    erased(void) noexcept = default;
+
+    erased(const erased& rhs) { _copy(rhs); }
+
+    erased(erased&& rhs) noexcept { _move(::lib::move(rhs)); }
+
+    template <class T, disable_if_t<disjunction<is_same<erased, decay_t<T>>,
+                                                is_template_of<in_place_type_t, decay_t<T>>>::value>* = nullptr>
+    erased(T&& data)
+    {
+        emplace<decay_t<T>>(::lib::forward<T>(data));
+    }
+
+    template <class T, class... Args>
+    explicit erased(in_place_type_t<T>, Args&&... args)
+    {
+        emplace<decay_t<T>>(::lib::forward<Args>(args)...);
+    }
+
+    ~erased(void) { reset(); }
+
+    erased& operator=(const erased& rhs)
+    {
+        if (this != &rhs)
+        {
+            reset();
+            _copy(rhs);
+        }
+        return (*this);
+    }
+
+    erased& operator=(erased&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            reset();
+            _move(::lib::move(rhs));
+        }
+        return (*this);
+    }
+
+    template <class T, disable_if_t<is_same<erased, decay_t<T>>::value>* = nullptr>
+    erased& operator=(T&& data)
+    {
+        emplace<decay_t<T>>(::lib::forward<T>(data));
+        return (*this);
+    }
+
+    template <class T, class... Args>
+    decay_t<T>& emplace(Args&&... args)
+    {
+        using Decayed = decay_t<T>;
+        static_assert(sizeof(Decayed) <= SIZE, "Insufficient size");
+        static_assert(ALIGN % alignof(Decayed) == 0, "Alignment is incorrect");
+        reset();
+        ::new (_buffer) Decayed{::lib::forward<Args>(args)...};
+        _vtable = &internal::_vtable_for<Interface, Decayed>::value;
+        return (*reinterpret_cast<Decayed*>(_buffer));
+    }
+
+    void reset(void) noexcept
+    {
+        if (_vtable)
+        {
+            _vtable->manage(_buffer, nullptr, internal::_any_operater::Delete);
+            _vtable = nullptr;
+        }
+    }
+
+    bool has_value(void) const noexcept { return (_vtable); }
+
+    template <class T>
+    T* target(void) noexcept
+    {
+        return ((_vtable && (_vtable->manage == internal::_any_manager<decay_t<T>>::invoke ||
+                             internal::_match_policy::foreign<decay_t<T>>(_vtable->manage)))
+                    ? reinterpret_cast<T*>(_buffer)
+                    : nullptr);
+    }
+
+    template <class Tag, class... Ts>
+    decltype(auto) call(Ts&&... args)
+    {
+        return (internal::_dispatch<Tag>(*_vtable, _buffer, ::lib::forward<Ts>(args)...));
+    }
+
+    template <class Tag, class... Ts>
+    decltype(auto) call(Ts&&... args) const
+    {
+        return (internal::_dispatch_const<Tag>(*_vtable, _buffer, ::lib::forward<Ts>(args)...));
+    }
+
+private:
+    void _copy(const erased& rhs)
+    {
+        if (rhs._vtable)
+        {
+            rhs._vtable->manage(rhs._buffer, _buffer, internal::_any_operater::Copy);
+            _vtable = rhs._vtable;
+        }
+    }
+
+    void _move(erased&& rhs) noexcept
+    {
+        if (rhs._vtable)
+        {
+            rhs._vtable->manage(rhs._buffer, _buffer, internal::_any_operater::Move);
+            _vtable     = rhs._vtable;
+            rhs._vtable = nullptr;
+        }
+    }
+};
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "type_traits.h"
+#include <cstring>
+
+namespace lib
+{
+namespace internal
+{
+struct bit64_tag
+{};
+struct bit32_tag
+{};
+using bit_size_tag = conditional_t<(sizeof(void*) == 8), bit64_tag, bit32_tag>;
+
+template <class Tag>
+struct hash_param;
+
+template <>
+struct hash_param<bit64_tag>
+{
+    static constexpr size_t fnv_prime    = 1099511628211ull;
+    static constexpr size_t offset_basis = 14695981039346656037ull;
+};
+
+template <>
+struct hash_param<bit32_tag>
+{
+    static constexpr size_t fnv_prime    = 16777619ull;
+    static constexpr size_t offset_basis = 2166136261ull;
+};
+
+using hash_param_t = hash_param<bit_size_tag>;
+
+inline constexpr size_t calc_fnv1a_hash(const char* values, size_t index)
+{
+    size_t hash = hash_param_t::offset_basis;
+    for (size_t i = 0; i <= index; ++i)
+    {
+        hash = (hash ^ values[i]) * hash_param_t::fnv_prime;
+    }
+    return (hash);
+}
+
+inline size_t _fnv1a_bytes(const void* data, size_t size, size_t seed = hash_param_t::offset_basis) noexcept
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i)
+    {
+        seed = (seed ^ bytes[i]) * hash_param_t::fnv_prime;
+    }
+    return (seed);
+}
+
+inline size_t _hash_words(const void* data, size_t size, size_t seed = hash_param_t::offset_basis) noexcept
+{
+    constexpr size_t shift = sizeof(size_t) * 4;
+    const auto*      bytes = static_cast<const unsigned char*>(data);
+    for (; size >= sizeof(size_t); size -= sizeof(size_t), bytes += sizeof(size_t))
+    {
+        size_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        seed = (seed ^ word) * hash_param_t::fnv_prime;
+        seed ^= seed >> shift;
+    }
+    if (size)
+    {
+        size_t word = 0;
+        std::memcpy(&word, bytes, size);
+        seed = (seed ^ word) * hash_param_t::fnv_prime;
+    }
+    seed ^= seed >> shift;
+    seed *= hash_param_t::fnv_prime;
+    return (seed ^ (seed >> shift));
+}
+
+struct _hash_fnv1a
+{
+    static size_t bytes(const void* data, size_t size) noexcept { return (_fnv1a_bytes(data, size)); }
+};
+
+struct _hash_word
+{
+    static size_t bytes(const void* data, size_t size) noexcept { return (_hash_words(data, size)); }
+};
+
+#ifdef LIB_HASH_FNV1A
+using _hash_policy = _hash_fnv1a;
+#else
+using _hash_policy = _hash_word;
+#endif
+
+inline size_t _hash_combine(size_t seed, size_t value) noexcept
+{
+    return (seed ^ (value + static_cast<size_t>(0x9e3779b97f4a7c15ull) + (seed << 6) + (seed >> 2)));
+}
+
+template <class T, bool = has_unique_object_representations<T>::value>
+struct _hash_bytes
+{};
+
+template <class T>
+struct _hash_bytes<T, true>
+{
+    size_t operator()(const T& value) const noexcept { return (_hash_policy::bytes(&value, sizeof(T))); }
+};
+}
+
+// Types with unique object representations are hashed byte-wise unless they specialise hash; other types have no
+// operator() until they do.
+template <class T, class = void>
+struct hash : internal::_hash_bytes<T>
+{};
+
+template <>
+struct hash<float>
+{
+    size_t operator()(float value) const noexcept
+    {
+        value = (value == 0.0f) ? 0.0f : value;
+        return (internal::_hash_policy::bytes(&value, sizeof(value)));
+    }
+};
+
+template <>
+struct hash<double>
+{
+    size_t operator()(double value) const noexcept
+    {
+        value = (value == 0.0) ? 0.0 : value;
+        return (internal::_hash_policy::bytes(&value, sizeof(value)));
+    }
+};
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include "type_traits.h"
+#include "hash.h"
+#include <cstring>
+
+namespace lib
+{
+template <size_t N>
+class inplace_string
+{
+private:
+    char   _data[N + 1];
+    size_t _size = 0;
+
+public:
+    using value_type = char;
+
+    inplace_string(void) noexcept { _data[0] = '\0'; }
+
+    template <size_t M>
+    inplace_string(const char (&str)[M]) noexcept
+    {
+        static_assert(M - 1 <= N, "Insufficient size");
+        const void* const terminator = std::memchr(str, '\0', M - 1);
+        assign(str, terminator ? static_cast<size_t>(static_cast<const char*>(terminator) - str) : M - 1);
+    }
+
+    template <size_t M>
+    inplace_string(const inplace_string<M>& rhs) noexcept
+    {
+        static_assert(M <= N, "Insufficient size");
+        assign(rhs.data(), rhs.size());
+    }
+
+    size_t size(void) const noexcept { return (_size); }
+    size_t length(void) const noexcept { return (_size); }
+    bool   empty(void) const noexcept { return (!_size); }
+    bool   full(void) const noexcept { return (_size == N); }
+
+    static constexpr size_t capacity(void) noexcept { return (N); }
+
+    char*       data(void) noexcept { return (_data); }
+    const char* data(void) const noexcept { return (_data); }
+    const char* c_str(void) const noexcept { return (_data); }
+    char*       begin(void) noexcept { return (_data); }
+    const char* begin(void) const noexcept { return (_data); }
+    char*       end(void) noexcept { return (_data + _size); }
+    const char* end(void) const noexcept { return (_data + _size); }
+
+    char&       operator[](size_t pos) noexcept { return (_data[pos]); }
+    const char& operator[](size_t pos) const noexcept { return (_data[pos]); }
+    char&       front(void) noexcept { return (_data[0]); }
+    const char& front(void) const noexcept { return (_data[0]); }
+    char&       back(void) noexcept { return (_data[_size - 1]); }
+    const char& back(void) const noexcept { return (_data[_size - 1]); }
+
+    bool assign(const char* str, size_t size) noexcept
+    {
+        if (size > N)
+        {
+            return (false);
+        }
+        std::memmove(_data, str, size);
+        _terminate(size);
+        return (true);
+    }
+
+    bool assign(const char* str) noexcept { return (assign(str, std::strlen(str))); }
+
+    bool append(const char* str, size_t size) noexcept
+    {
+        if (size > N - _size)
+        {
+            return (false);
+        }
+        std::memmove(_data + _size, str, size);
+        _terminate(_size + size);
+        return (true);
+    }
+
+    bool append(const char* str) noexcept { return (append(str, std::strlen(str))); }
+
+    template <size_t M>
+    bool append(const inplace_string<M>& rhs) noexcept
+    {
+        return (append(rhs.data(), rhs.size()));
+    }
+
+    bool push_back(char c) noexcept
+    {
+        if (full())
+        {
+            return (false);
+        }
+        _data[_size] = c;
+        _terminate(_size + 1);
+        return (true);
+    }
+
+    void pop_back(void) noexcept { _terminate(_size - 1); }
+
+    void clear(void) noexcept { _terminate(0); }
+
+    bool resize(size_t size, char c = '\0') noexcept
+    {
+        if (size > N)
+        {
+            return (false);
+        }
+        if (size > _size)
+        {
+            std::memset(_data + _size, c, size - _size);
+        }
+        _terminate(size);
+        return (true);
+    }
+
+    int compare(const char* str, size_t size) const noexcept
+    {
+        const int result = std::memcmp(_data, str, (_size < size) ? _size : size);
+        return (result ? result : (_size < size) ? -1 : (_size > size) ? 1 : 0);
+    }
+
+private:
+    void _terminate(size_t size) noexcept
+    {
+        _size        = size;
+        _data[_size] = '\0';
+    }
+};
+
+template <size_t N, size_t M>
+bool operator==(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (lhs.size() == rhs.size() && !std::memcmp(lhs.data(), rhs.data(), lhs.size()));
+}
+
+template <size_t N>
+bool operator==(const inplace_string<N>& lhs, const char* rhs) noexcept
+{
+    return (!lhs.compare(rhs, std::strlen(rhs)));
+}
+
+template <size_t N>
+bool operator==(const char* lhs, const inplace_string<N>& rhs) noexcept
+{
+    return (rhs == lhs);
+}
+
+template <size_t N, size_t M>
+bool operator!=(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (!(lhs == rhs));
+}
+
+template <size_t N>
+bool operator!=(const inplace_string<N>& lhs, const char* rhs) noexcept
+{
+    return (!(lhs == rhs));
+}
+
+template <size_t N>
+bool operator!=(const char* lhs, const inplace_string<N>& rhs) noexcept
+{
+    return (!(rhs == lhs));
+}
+
+template <size_t N, size_t M>
+bool operator<(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (lhs.compare(rhs.data(), rhs.size()) < 0);
+}
+
+template <size_t N, size_t M>
+bool operator>(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (rhs < lhs);
+}
+
+template <size_t N, size_t M>
+bool operator<=(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (!(rhs < lhs));
+}
+
+template <size_t N, size_t M>
+bool operator>=(const inplace_string<N>& lhs, const inplace_string<M>& rhs) noexcept
+{
+    return (!(lhs < rhs));
+}
+
+template <size_t N>
+struct hash<inplace_string<N>>
+{
+    size_t operator()(const inplace_string<N>& value) const noexcept
+    {
+        return (internal::_hash_policy::bytes(value.data(), value.size()));
+    }
+};
+}
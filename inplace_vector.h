@@ -0,0 +1,225 @@
+#pragma once
+
+#include "type_traits.h"
+#include "new.h"
+#include "hash.h"
+
+namespace lib
+{
+namespace internal
+{
+template <class T, size_t N>
+class _inplace_vector_storage
+{
+protected:
+    alignas(T) unsigned char _buffer[N ? N * sizeof(T) : 1];
+    size_t _size = 0;
+
+    T*       _data(void) noexcept { return (reinterpret_cast<T*>(_buffer)); }
+    const T* _data(void) const noexcept { return (reinterpret_cast<const T*>(_buffer)); }
+
+    void _destroy_from(size_t first) noexcept
+    {
+        if (!is_trivially_destructible<T>::value)
+        {
+            for (size_t i = first; i < _size; ++i)
+            {
+                _data()[i].~T();
+            }
+        }
+        _size = first;
+    }
+
+    void _copy_from(const _inplace_vector_storage& rhs)
+    {
+        for (; _size < rhs._size; ++_size)
+        {
+            ::new (_data() + _size) T(rhs._data()[_size]);
+        }
+    }
+
+    void _move_from(_inplace_vector_storage& rhs)
+    {
+        for (; _size < rhs._size; ++_size)
+        {
+            ::new (_data() + _size) T(::lib::move(rhs._data()[_size]));
+        }
+    }
+};
+
+template <bool Trivial, class T, size_t N>
+class _inplace_vector_base : public _inplace_vector_storage<T, N>
+{};
+
+template <class T, size_t N>
+class _inplace_vector_base<false, T, N> : public _inplace_vector_storage<T, N>
+{
+protected:
+    _inplace_vector_base(void) noexcept = default;
+
+    _inplace_vector_base(const _inplace_vector_base& rhs) : _inplace_vector_base() { this->_copy_from(rhs); }
+
+    _inplace_vector_base(_inplace_vector_base&& rhs) : _inplace_vector_base() { this->_move_from(rhs); }
+
+    ~_inplace_vector_base(void) { this->_destroy_from(0); }
+
+    _inplace_vector_base& operator=(const _inplace_vector_base& rhs)
+    {
+        if (this != &rhs)
+        {
+            this->_destroy_from(0);
+            this->_copy_from(rhs);
+        }
+        return (*this);
+    }
+
+    _inplace_vector_base& operator=(_inplace_vector_base&& rhs)
+    {
+        if (this != &rhs)
+        {
+            this->_destroy_from(0);
+            this->_move_from(rhs);
+        }
+        return (*this);
+    }
+};
+}
+
+template <class T, size_t N>
+class inplace_vector : private internal::_inplace_vector_base<is_trivially_copyable<T>::value, T, N>
+{
+    static_assert(!is_array<T>::value, "Array cannot be used.");
+    static_assert(is_object<T>::value, "T param must be object.");
+
+public:
+    using value_type = T;
+
+    inplace_vector(void) noexcept = default;
+
+    size_t size(void) const noexcept { return (this->_size); }
+    bool   empty(void) const noexcept { return (!this->_size); }
+    bool   full(void) const noexcept { return (this->_size == N); }
+
+    static constexpr size_t capacity(void) noexcept { return (N); }
+
+    T*       data(void) noexcept { return (this->_data()); }
+    const T* data(void) const noexcept { return (this->_data()); }
+    T*       begin(void) noexcept { return (data()); }
+    const T* begin(void) const noexcept { return (data()); }
+    T*       end(void) noexcept { return (data() + this->_size); }
+    const T* end(void) const noexcept { return (data() + this->_size); }
+
+    T&       operator[](size_t pos) noexcept { return (data()[pos]); }
+    const T& operator[](size_t pos) const noexcept { return (data()[pos]); }
+    T&       front(void) noexcept { return (data()[0]); }
+    const T& front(void) const noexcept { return (data()[0]); }
+    T&       back(void) noexcept { return (data()[this->_size - 1]); }
+    const T& back(void) const noexcept { return (data()[this->_size - 1]); }
+
+    template <class... Args>
+    T* emplace_back(Args&&... args)
+    {
+        if (full())
+        {
+            return (nullptr);
+        }
+        T* const value = ::new (data() + this->_size) T(::lib::forward<Args>(args)...);
+        ++this->_size;
+        return (value);
+    }
+
+    bool push_back(const T& value) { return (emplace_back(value)); }
+    bool push_back(T&& value) { return (emplace_back(::lib::move(value))); }
+
+    void pop_back(void) noexcept { this->_destroy_from(this->_size - 1); }
+
+    void clear(void) noexcept { this->_destroy_from(0); }
+
+    bool resize(size_t size)
+    {
+        if (size > N)
+        {
+            return (false);
+        }
+        this->_destroy_from(size < this->_size ? size : this->_size);
+        for (; this->_size < size; ++this->_size)
+        {
+            ::new (data() + this->_size) T();
+        }
+        return (true);
+    }
+};
+
+template <class T, size_t N>
+bool operator==(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    if (lhs.size() != rhs.size())
+    {
+        return (false);
+    }
+    for (size_t i = 0; i < lhs.size(); ++i)
+    {
+        if (!(lhs[i] == rhs[i]))
+        {
+            return (false);
+        }
+    }
+    return (true);
+}
+
+template <class T, size_t N>
+bool operator!=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    return (!(lhs == rhs));
+}
+
+template <class T, size_t N>
+bool operator<(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    const size_t size = (lhs.size() < rhs.size()) ? lhs.size() : rhs.size();
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (lhs[i] < rhs[i])
+        {
+            return (true);
+        }
+        if (rhs[i] < lhs[i])
+        {
+            return (false);
+        }
+    }
+    return (lhs.size() < rhs.size());
+}
+
+template <class T, size_t N>
+bool operator>(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    return (rhs < lhs);
+}
+
+template <class T, size_t N>
+bool operator<=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    return (!(rhs < lhs));
+}
+
+template <class T, size_t N>
+bool operator>=(const inplace_vector<T, N>& lhs, const inplace_vector<T, N>& rhs)
+{
+    return (!(lhs < rhs));
+}
+
+template <class T, size_t N>
+struct hash<inplace_vector<T, N>>
+{
+    size_t operator()(const inplace_vector<T, N>& value) const
+    {
+        size_t seed = value.size();
+        for (const T& element : value)
+        {
+            seed = internal::_hash_combine(seed, hash<T>{}(element));
+        }
+        return (seed);
+    }
+};
+}
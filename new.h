@@ -1,6 +1,12 @@
 #pragma once
 
-#ifdef _WIN32
+#if defined(__has_include)
+#if __has_include(<new>)
+#define LIB_HAS_STD_NEW
+#endif
+#endif
+
+#if defined(_WIN32) || defined(LIB_HAS_STD_NEW)
 #include <new>
 #else
 #include "type_traits.h"
@@ -0,0 +1,279 @@
+#pragma once
+
+#include "thread_pool.h"
+#include "variant.h"
+#include <memory>
+#include <vector>
+
+namespace lib
+{
+namespace internal
+{
+constexpr size_t _parallel_partials_budget = 1024;
+
+template <class Pool>
+size_t _parallel_chunk_count(const Pool& pool, size_t count, size_t grain) noexcept
+{
+    grain               = grain ? grain : 1;
+    const size_t limit  = pool.size() * 4;
+    const size_t chunks = (count + grain - 1) / grain;
+    return ((chunks < limit) ? chunks : limit);
+}
+
+template <class Pool, class Func>
+void _parallel_chunks(Pool& pool, size_t count, size_t chunks, Func&& func)
+{
+    pool.parallel_for(0, chunks, [count, chunks, &func](size_t chunk) {
+        func(count * chunk / chunks, count * (chunk + 1) / chunks, chunk);
+    });
+}
+
+template <class T, class Any, class Func>
+bool _apply_held(Any& target, Func& func)
+{
+    const T* const value = target.template _cast<const T>();
+    if (value)
+    {
+        func(*value);
+    }
+    return (value);
+}
+
+struct _variant_dispatch
+{
+    template <class Variant, class Func>
+    static void apply(Variant& target, Func&& func)
+    {
+        visit<void>([&func](auto& value) { func(value); }, target);
+    }
+};
+
+template <class... Ts>
+struct _any_dispatch
+{
+    template <class Any, class Func>
+    static void apply(Any& target, Func&& func)
+    {
+        const bool held[] = {_apply_held<Ts>(target, func)...};
+#ifndef NDEBUG
+        bool matched = false;
+        for (const bool value : held)
+        {
+            matched = matched || value;
+        }
+        if (!matched)
+        {
+            _cast_failed(nullptr, target._signature());
+        }
+#else
+        (void)held;
+#endif
+    }
+};
+
+template <class Dispatch, class Pool, class Element, class Visitor>
+void _parallel_visit(Pool& pool, Element* first, size_t count, Visitor& vis, size_t grain)
+{
+    _parallel_chunks(pool, count, _parallel_chunk_count(pool, count, grain),
+                     [first, &vis](size_t lo, size_t hi, size_t) {
+                         for (size_t i = lo; i < hi; ++i)
+                         {
+                             Dispatch::apply(first[i], vis);
+                         }
+                     });
+}
+
+template <class Dispatch, class Pool, class Element, class Output, class Visitor>
+void _parallel_transform(Pool& pool, Element* first, size_t count, Output* out, Visitor& vis, size_t grain)
+{
+    _parallel_chunks(pool, count, _parallel_chunk_count(pool, count, grain),
+                     [first, out, &vis](size_t lo, size_t hi, size_t) {
+                         for (size_t i = lo; i < hi; ++i)
+                         {
+                             Output& dst = out[i];
+                             Dispatch::apply(first[i], [&dst, &vis](auto&& value) { dst = vis(value); });
+                         }
+                     });
+}
+
+// Partial results of a reduce, one per chunk: on the stack up to _parallel_partials_budget bytes, on the heap above.
+template <class T>
+class _parallel_partials
+{
+private:
+    static constexpr size_t INLINE = _parallel_partials_budget / (sizeof(T) + 1);
+
+    alignas(T) unsigned char         _inline[INLINE ? INLINE * (sizeof(T) + 1) : 1];
+    std::unique_ptr<unsigned char[]> _heap;
+    T*                               _values;
+    bool*                            _built;
+    const size_t                     _count;
+
+public:
+    explicit _parallel_partials(size_t count) : _count(count)
+    {
+        unsigned char* storage = _inline;
+        if (count > INLINE)
+        {
+            _heap.reset(new unsigned char[count * (sizeof(T) + 1) + alignof(T) - 1]);
+            const uintptr_t address = reinterpret_cast<uintptr_t>(_heap.get());
+            storage                 = _heap.get() + (alignof(T) - address % alignof(T)) % alignof(T);
+        }
+        _values = reinterpret_cast<T*>(storage);
+        _built  = reinterpret_cast<bool*>(storage + count * sizeof(T));
+        for (size_t i = 0; i < count; ++i)
+        {
+            _built[i] = false;
+        }
+    }
+
+    _parallel_partials(const _parallel_partials&) = delete;
+    _parallel_partials& operator=(const _parallel_partials&) = delete;
+
+    ~_parallel_partials(void)
+    {
+        for (size_t i = 0; i < _count; ++i)
+        {
+            if (_built[i])
+            {
+                _values[i].~T();
+            }
+        }
+    }
+
+    void emplace(size_t chunk, T&& value)
+    {
+        ::new (&_values[chunk]) T(::lib::move(value));
+        _built[chunk] = true;
+    }
+
+    const T& operator[](size_t chunk) const noexcept { return (_values[chunk]); }
+};
+
+template <class Dispatch, class Pool, class Element, class T, class Visitor, class Combine>
+T _parallel_reduce(Pool& pool, Element* first, size_t count, T identity, Visitor& vis, Combine& combine,
+                   size_t grain)
+{
+    const size_t          chunks = _parallel_chunk_count(pool, count, grain);
+    _parallel_partials<T> partials{chunks};
+    _parallel_chunks(pool, count, chunks,
+                     [first, &partials, &identity, &vis, &combine](size_t lo, size_t hi, size_t chunk) {
+                         T acc = identity;
+                         for (size_t i = lo; i < hi; ++i)
+                         {
+                             Dispatch::apply(first[i],
+                                             [&acc, &vis, &combine](auto&& value) { acc = combine(acc, vis(value)); });
+                         }
+                         partials.emplace(chunk, ::lib::move(acc));
+                     });
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        identity = combine(identity, partials[chunk]);
+    }
+    return (identity);
+}
+
+template <size_t Index, class Pool, class Variant, class Visitor>
+bool _visit_group(Pool& pool, Variant* first, const size_t* positions, const size_t* offsets, Visitor& vis,
+                  size_t grain)
+{
+    const size_t begin = offsets[Index];
+    const size_t count = offsets[Index + 1] - begin;
+    _parallel_chunks(pool, count, _parallel_chunk_count(pool, count, grain),
+                     [first, positions, begin, &vis](size_t lo, size_t hi, size_t) {
+                         for (size_t i = begin + lo; i < begin + hi; ++i)
+                         {
+                             vis(get<Index>(first[positions[i]]));
+                         }
+                     });
+    return (true);
+}
+
+template <class Pool, class Variant, class Visitor, size_t... Indices>
+void _visit_groups(Pool& pool, Variant* first, const size_t* positions, const size_t* offsets, Visitor& vis,
+                   size_t grain, index_sequence<Indices...>)
+{
+    const bool visited[] = {_visit_group<Indices>(pool, first, positions, offsets, vis, grain)...};
+    (void)visited;
+}
+
+template <class Variant>
+using _enable_if_variant_t = enable_if_t<is_template_of<variant, remove_const_t<Variant>>::value>;
+
+template <class Any>
+using _enable_if_any_t = enable_if_t<is_base_of<_any, remove_const_t<Any>>::value>;
+}
+
+template <class Pool, class Variant, class Visitor, internal::_enable_if_variant_t<Variant>* = nullptr>
+void parallel_visit(Pool& pool, Variant* first, size_t count, Visitor&& vis, size_t grain = 1)
+{
+    internal::_parallel_visit<internal::_variant_dispatch>(pool, first, count, vis, grain);
+}
+
+// In the closed-set any overloads every element must hold one of Ts...: debug builds report any other element, or
+// an empty one, through the cast failure hook, and release builds skip it.
+template <class... Ts, class Pool, class Any, class Visitor, internal::_enable_if_any_t<Any>* = nullptr>
+void parallel_visit(Pool& pool, Any* first, size_t count, Visitor&& vis, size_t grain = 1)
+{
+    static_assert(sizeof...(Ts), "Closed set must not be empty");
+    internal::_parallel_visit<internal::_any_dispatch<Ts...>>(pool, first, count, vis, grain);
+}
+
+template <class Pool, class Variant, class Output, class Visitor, internal::_enable_if_variant_t<Variant>* = nullptr>
+void parallel_transform(Pool& pool, Variant* first, size_t count, Output* out, Visitor&& vis, size_t grain = 1)
+{
+    internal::_parallel_transform<internal::_variant_dispatch>(pool, first, count, out, vis, grain);
+}
+
+template <class... Ts, class Pool, class Any, class Output, class Visitor, internal::_enable_if_any_t<Any>* = nullptr>
+void parallel_transform(Pool& pool, Any* first, size_t count, Output* out, Visitor&& vis, size_t grain = 1)
+{
+    static_assert(sizeof...(Ts), "Closed set must not be empty");
+    internal::_parallel_transform<internal::_any_dispatch<Ts...>>(pool, first, count, out, vis, grain);
+}
+
+template <class Pool, class Variant, class T, class Visitor, class Combine,
+          internal::_enable_if_variant_t<Variant>* = nullptr>
+T parallel_reduce(Pool& pool, Variant* first, size_t count, T identity, Visitor&& vis, Combine&& combine,
+                  size_t grain = 1)
+{
+    return (internal::_parallel_reduce<internal::_variant_dispatch>(pool, first, count, ::lib::move(identity), vis,
+                                                                    combine, grain));
+}
+
+template <class... Ts, class Pool, class Any, class T, class Visitor, class Combine,
+          internal::_enable_if_any_t<Any>* = nullptr>
+T parallel_reduce(Pool& pool, Any* first, size_t count, T identity, Visitor&& vis, Combine&& combine,
+                  size_t grain = 1)
+{
+    static_assert(sizeof...(Ts), "Closed set must not be empty");
+    return (internal::_parallel_reduce<internal::_any_dispatch<Ts...>>(pool, first, count, ::lib::move(identity), vis,
+                                                                       combine, grain));
+}
+
+template <class Pool, class Variant, class Visitor, internal::_enable_if_variant_t<Variant>* = nullptr>
+void parallel_visit_grouped(Pool& pool, Variant* first, size_t count, Visitor&& vis, size_t grain = 1)
+{
+    constexpr size_t    alternatives = variant_size<remove_const_t<Variant>>::value;
+    size_t              offsets[alternatives + 1]{};
+    std::vector<size_t> positions(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        ++offsets[first[i].index() + 1];
+    }
+    for (size_t k = 1; k <= alternatives; ++k)
+    {
+        offsets[k] += offsets[k - 1];
+    }
+    size_t cursors[alternatives];
+    for (size_t k = 0; k < alternatives; ++k)
+    {
+        cursors[k] = offsets[k];
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        positions[cursors[first[i].index()]++] = i;
+    }
+    internal::_visit_groups(pool, first, positions.data(), offsets, vis, grain, make_index_sequence<alternatives>{});
+}
+}
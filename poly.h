@@ -0,0 +1,87 @@
+#pragma once
+
+#include "any.h"
+
+namespace lib
+{
+template <class Interface, size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class poly : public internal::_any
+{
+private:
+    alignas(ALIGN) char _buffer[SIZE]{};
+    ptrdiff_t _offset = 0;
+
+public:
+    poly(void) noexcept : _any(_buffer, SIZE, ALIGN) {}
+
+    poly(const poly& rhs) : _any(_buffer, SIZE, ALIGN), _offset(rhs._offset) { copy_data(rhs); }
+
+    poly(poly&& rhs) noexcept : _any(_buffer, SIZE, ALIGN), _offset(rhs._offset) { move_data(::lib::move(rhs)); }
+
+    template <class T, disable_if_t<disjunction<is_same<poly, decay_t<T>>,
+                                                is_template_of<in_place_type_t, decay_t<T>>>::value>* = nullptr>
+    poly(T&& data) : _any(_buffer, SIZE, ALIGN)
+    {
+        emplace<decay_t<T>>(::lib::forward<T>(data));
+    }
+
+    template <class T, class... Args>
+    explicit poly(in_place_type_t<T>, Args&&... args) : _any(_buffer, SIZE, ALIGN)
+    {
+        emplace<decay_t<T>>(::lib::forward<Args>(args)...);
+    }
+
+    poly& operator=(const poly& rhs)
+    {
+        if (this != &rhs)
+        {
+            copy_data(rhs);
+            _offset = rhs._offset;
+        }
+        return (*this);
+    }
+
+    poly& operator=(poly&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            move_data(::lib::move(rhs));
+            _offset = rhs._offset;
+        }
+        return (*this);
+    }
+
+    template <class T, disable_if_t<is_same<poly, decay_t<T>>::value>* = nullptr>
+    poly& operator=(T&& data)
+    {
+        emplace<decay_t<T>>(::lib::forward<T>(data));
+        return (*this);
+    }
+
+    template <class T, class... Args>
+    decay_t<T>& emplace(Args&&... args)
+    {
+        static_assert(is_base_of<Interface, decay_t<T>>::value, "T must derive from Interface");
+        static_assert(sizeof(decay_t<T>) <= SIZE, "Insufficient size");
+        static_assert(ALIGN % alignof(decay_t<T>) == 0, "Alignment is incorrect");
+        _record_capacity<decay_t<T>, SIZE, ALIGN>();
+        auto& data = _emplace<decay_t<T>>(::lib::forward<Args>(args)...);
+        _offset    = reinterpret_cast<char*>(static_cast<Interface*>(&data)) - _buffer;
+        return (data);
+    }
+
+    Interface* get(void) noexcept { return (has_value() ? reinterpret_cast<Interface*>(_buffer + _offset) : nullptr); }
+
+    const Interface* get(void) const noexcept
+    {
+        return (has_value() ? reinterpret_cast<const Interface*>(_buffer + _offset) : nullptr);
+    }
+
+    Interface*       operator->(void) noexcept { return (get()); }
+    const Interface* operator->(void) const noexcept { return (get()); }
+    Interface&       operator*(void) noexcept { return (*get()); }
+    const Interface& operator*(void) const noexcept { return (*get()); }
+
+    explicit operator bool(void) const noexcept { return (has_value()); }
+};
+}
@@ -0,0 +1,331 @@
+#pragma once
+
+#include "any.h"
+#include "variant.h"
+#include <cstring>
+
+namespace lib
+{
+class byte_writer
+{
+private:
+    unsigned char* const _data;
+    const size_t         _capacity;
+    size_t               _size = 0;
+
+public:
+    byte_writer(void* data, size_t capacity) noexcept : _data(static_cast<unsigned char*>(data)), _capacity(capacity)
+    {}
+
+    size_t size(void) const noexcept { return (_size); }
+    size_t remaining(void) const noexcept { return (_capacity - _size); }
+
+    unsigned char* reserve(size_t size) noexcept
+    {
+        if (size > remaining())
+        {
+            return (nullptr);
+        }
+        unsigned char* const dst = _data + _size;
+        _size += size;
+        return (dst);
+    }
+
+    bool write(const void* src, size_t size) noexcept
+    {
+        unsigned char* const dst = reserve(size);
+        if (dst)
+        {
+            std::memcpy(dst, src, size);
+        }
+        return (dst);
+    }
+
+    void truncate(size_t size) noexcept { _size = (size < _size) ? size : _size; }
+};
+
+class byte_reader
+{
+private:
+    const unsigned char* const _data;
+    const size_t               _capacity;
+    size_t                     _size = 0;
+
+public:
+    byte_reader(const void* data, size_t capacity) noexcept :
+        _data(static_cast<const unsigned char*>(data)), _capacity(capacity)
+    {}
+
+    size_t size(void) const noexcept { return (_size); }
+    size_t remaining(void) const noexcept { return (_capacity - _size); }
+
+    const unsigned char* consume(size_t size) noexcept
+    {
+        if (size > remaining())
+        {
+            return (nullptr);
+        }
+        const unsigned char* const src = _data + _size;
+        _size += size;
+        return (src);
+    }
+
+    bool read(void* dst, size_t size) noexcept
+    {
+        const unsigned char* const src = consume(size);
+        if (src)
+        {
+            std::memcpy(dst, src, size);
+        }
+        return (src);
+    }
+
+    void rewind(size_t size) noexcept { _size = (size < _size) ? size : _size; }
+};
+
+namespace internal
+{
+template <class T>
+using _is_padding_free =
+    disjunction<has_unique_object_representations<T>, is_same<remove_cv_t<T>, float>, is_same<remove_cv_t<T>, double>>;
+}
+
+template <class T, class = void>
+struct codec;
+
+// Copies the object representation as is, so the encoding is host-endian and is only provided for
+// types without padding bytes. Other types need their own codec specialisation.
+template <class T>
+struct codec<T, enable_if_t<conjunction<is_trivially_copyable<T>, internal::_is_padding_free<T>>::value>>
+{
+    static constexpr bool block_copy = true;
+
+    static bool encode(byte_writer& out, const T& value) noexcept { return (out.write(&value, sizeof(T))); }
+    static bool decode(byte_reader& in, void* dst) noexcept { return (in.read(dst, sizeof(T))); }
+};
+
+namespace internal
+{
+template <size_t N>
+using _serial_index_t =
+    conditional_t<(N <= 0xFF), unsigned char, conditional_t<(N <= 0xFFFF), unsigned short, unsigned int>>;
+
+template <class Codec, class = void>
+struct _has_block_copy : false_type
+{};
+
+template <class Codec>
+struct _has_block_copy<Codec, enable_if_t<Codec::block_copy>> : true_type
+{};
+
+template <class T>
+using _is_block_codec = conjunction<is_trivially_copyable<T>, _has_block_copy<codec<T>>>;
+
+template <class Variant, size_t Index>
+bool _encode_alternative(byte_writer& out, const Variant& value)
+{
+    return (codec<variant_alternative_t<Index, Variant>>::encode(out, get<Index>(value)));
+}
+
+template <class Variant, size_t Index>
+bool _decode_alternative(byte_reader& in, Variant& value)
+{
+    return (value._construct_with(
+        Index, [&in](void* dst) { return (codec<variant_alternative_t<Index, Variant>>::decode(in, dst)); }));
+}
+
+template <class... Ts, size_t... Indices>
+bool _encode_variant(byte_writer& out, const variant<Ts...>& value, index_sequence<Indices...>)
+{
+    using index_type = _serial_index_t<sizeof...(Ts)>;
+    constexpr bool (*table[])(byte_writer&, const variant<Ts...>&) = {
+        _encode_alternative<variant<Ts...>, Indices>...};
+    const size_t     mark  = out.size();
+    const index_type index = static_cast<index_type>(value.index());
+    if (out.write(&index, sizeof(index)) && table[index](out, value))
+    {
+        return (true);
+    }
+    out.truncate(mark);
+    return (false);
+}
+
+template <class... Ts, size_t... Indices>
+bool _decode_variant(byte_reader& in, variant<Ts...>& value, index_sequence<Indices...>)
+{
+    using index_type = _serial_index_t<sizeof...(Ts)>;
+    constexpr bool (*table[])(byte_reader&, variant<Ts...>&) = {_decode_alternative<variant<Ts...>, Indices>...};
+    const size_t mark  = in.size();
+    index_type   index = 0;
+    if (in.read(&index, sizeof(index)) && index < sizeof...(Ts) && table[index](in, value))
+    {
+        return (true);
+    }
+    in.rewind(mark);
+    return (false);
+}
+
+template <class... Ts>
+size_t _encode_range(byte_writer& out, const variant<Ts...>* values, size_t count, true_type)
+{
+    using index_type          = _serial_index_t<sizeof...(Ts)>;
+    constexpr size_t sizes[] = {sizeof(Ts)...};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const index_type     index = static_cast<index_type>(values[i].index());
+        unsigned char* const dst   = out.reserve(sizeof(index) + sizes[index]);
+        if (!dst)
+        {
+            return (i);
+        }
+        std::memcpy(dst, &index, sizeof(index));
+        std::memcpy(dst + sizeof(index), values[i]._get_buffer(), sizes[index]);
+    }
+    return (count);
+}
+
+template <class... Ts>
+size_t _encode_range(byte_writer& out, const variant<Ts...>* values, size_t count, false_type)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!_encode_variant(out, values[i], make_index_sequence<sizeof...(Ts)>{}))
+        {
+            return (i);
+        }
+    }
+    return (count);
+}
+
+template <class... Ts>
+size_t _decode_range(byte_reader& in, variant<Ts...>* values, size_t count, true_type)
+{
+    using index_type          = _serial_index_t<sizeof...(Ts)>;
+    constexpr size_t sizes[] = {sizeof(Ts)...};
+    for (size_t i = 0; i < count; ++i)
+    {
+        const size_t mark  = in.size();
+        index_type   index = 0;
+        if (!in.read(&index, sizeof(index)) || index >= sizeof...(Ts))
+        {
+            in.rewind(mark);
+            return (i);
+        }
+        const size_t               size = sizes[index];
+        const unsigned char* const src  = in.consume(size);
+        if (!src)
+        {
+            in.rewind(mark);
+            return (i);
+        }
+        values[i]._construct_with(index, [src, size](void* dst) {
+            std::memcpy(dst, src, size);
+            return (true);
+        });
+    }
+    return (count);
+}
+
+template <class... Ts>
+size_t _decode_range(byte_reader& in, variant<Ts...>* values, size_t count, false_type)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!_decode_variant(in, values[i], make_index_sequence<sizeof...(Ts)>{}))
+        {
+            return (i);
+        }
+    }
+    return (count);
+}
+
+template <class T>
+bool _encode_held(byte_writer& out, const _any& value)
+{
+    return (codec<T>::encode(out, *value._cast<const T>()));
+}
+
+template <class T>
+bool _decode_held(byte_reader& in, _any& value)
+{
+    return (value._construct_with<T>([&in](void* dst) { return (codec<T>::decode(in, dst)); }));
+}
+}
+
+template <class... Ts>
+bool encode(byte_writer& out, const variant<Ts...>& value)
+{
+    return (internal::_encode_variant(out, value, make_index_sequence<sizeof...(Ts)>{}));
+}
+
+template <class... Ts>
+bool decode(byte_reader& in, variant<Ts...>& value)
+{
+    return (internal::_decode_variant(in, value, make_index_sequence<sizeof...(Ts)>{}));
+}
+
+template <class... Ts>
+size_t encode(byte_writer& out, const variant<Ts...>* values, size_t count)
+{
+    return (internal::_encode_range(out, values, count, conjunction<internal::_is_block_codec<Ts>...>{}));
+}
+
+template <class... Ts>
+size_t decode(byte_reader& in, variant<Ts...>* values, size_t count)
+{
+    return (internal::_decode_range(in, values, count, conjunction<internal::_is_block_codec<Ts>...>{}));
+}
+
+template <class... Ts, size_t SIZE, size_t ALIGN>
+bool encode_any(byte_writer& out, const any<SIZE, ALIGN>& value)
+{
+    static_assert(sizeof...(Ts), "Closed set must not be empty");
+    using index_type = internal::_serial_index_t<sizeof...(Ts) + 1>;
+    constexpr bool (*table[])(byte_writer&, const internal::_any&) = {internal::_encode_held<Ts>...};
+    const bool held[] = {(value.template _cast<const Ts>() != nullptr)...};
+
+    index_type index = 0;
+    while (index < sizeof...(Ts) && !held[index])
+    {
+        ++index;
+    }
+    if (index == sizeof...(Ts) && value.has_value())
+    {
+        return (false);
+    }
+    const size_t mark = out.size();
+    if (out.write(&index, sizeof(index)) && (index == sizeof...(Ts) || table[index](out, value)))
+    {
+        return (true);
+    }
+    out.truncate(mark);
+    return (false);
+}
+
+template <class... Ts, size_t SIZE, size_t ALIGN>
+bool decode_any(byte_reader& in, any<SIZE, ALIGN>& value)
+{
+    static_assert(sizeof...(Ts), "Closed set must not be empty");
+    static_assert(conjunction<bool_constant<sizeof(Ts) <= SIZE>...>::value, "Insufficient size");
+    static_assert(conjunction<bool_constant<ALIGN % alignof(Ts) == 0>...>::value, "Alignment is incorrect");
+    using index_type = internal::_serial_index_t<sizeof...(Ts) + 1>;
+    constexpr bool (*table[])(byte_reader&, internal::_any&) = {internal::_decode_held<Ts>...};
+
+    const size_t mark  = in.size();
+    index_type   index = 0;
+    if (in.read(&index, sizeof(index)) && index <= sizeof...(Ts))
+    {
+        if (index == sizeof...(Ts))
+        {
+            value.reset();
+            return (true);
+        }
+        if (table[index](in, value))
+        {
+            return (true);
+        }
+    }
+    in.rewind(mark);
+    return (false);
+}
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "any.h"
+#include "task_slot.h"
+
+namespace lib
+{
+struct signal_handle
+{
+    unsigned int index      = ~0u;
+    unsigned int generation = 0;
+};
+
+template <class, size_t SIZE, size_t CAPACITY = 16, size_t ALIGN = alignof(max_align_t)>
+class signal;
+
+template <class... Args, size_t SIZE, size_t CAPACITY, size_t ALIGN>
+class signal<void(Args...), SIZE, CAPACITY, ALIGN>
+{
+    static_assert(CAPACITY < ~0u, "CAPACITY is too large");
+
+public:
+    using slot_type = function<void(Args...), SIZE, ALIGN>;
+
+private:
+    static constexpr unsigned int NONE = ~0u;
+
+    internal::_task_slot<slot_type> _slots[CAPACITY];
+    unsigned int                    _ids[CAPACITY];
+    bool                            _alive[CAPACITY];
+    unsigned int                    _positions[CAPACITY];
+    unsigned int                    _generations[CAPACITY];
+    unsigned int                    _free;
+    unsigned int                    _count    = 0;
+    unsigned int                    _emitting = 0;
+    bool                            _dirty    = false;
+
+public:
+    signal(void) noexcept : _free(CAPACITY ? 0 : NONE)
+    {
+        for (unsigned int i = 0; i < CAPACITY; ++i)
+        {
+            _positions[i]   = (i + 1 < CAPACITY) ? i + 1 : NONE;
+            _generations[i] = 0;
+        }
+    }
+    signal(const signal&) = delete;
+    signal& operator=(const signal&) = delete;
+
+    ~signal(void)
+    {
+        for (unsigned int pos = 0; pos < _count; ++pos)
+        {
+            _slots[pos].destroy();
+        }
+    }
+
+    size_t size(void) const noexcept { return (_count); }
+    bool   full(void) const noexcept { return (_free == NONE); }
+
+    template <class F>
+    signal_handle connect(F&& func)
+    {
+        signal_handle handle;
+        if (_free == NONE)
+        {
+            return (handle);
+        }
+        const unsigned int id  = _free;
+        const unsigned int pos = _count;
+        _slots[pos].construct(::lib::forward<F>(func));
+        _free          = _positions[id];
+        _positions[id] = pos;
+        _ids[pos]      = id;
+        _alive[pos]    = true;
+        ++_count;
+        handle.index      = id;
+        handle.generation = _generations[id];
+        return (handle);
+    }
+
+    bool connected(signal_handle handle) const noexcept
+    {
+        if (handle.index >= CAPACITY || _generations[handle.index] != handle.generation)
+        {
+            return (false);
+        }
+        const unsigned int pos = _positions[handle.index];
+        return (pos < _count && _ids[pos] == handle.index && _alive[pos]);
+    }
+
+    bool disconnect(signal_handle handle) noexcept
+    {
+        if (!connected(handle))
+        {
+            return (false);
+        }
+        const unsigned int pos = _positions[handle.index];
+        if (_emitting)
+        {
+            _alive[pos] = false;
+            _dirty      = true;
+        }
+        else
+        {
+            _erase(pos);
+        }
+        return (true);
+    }
+
+    void emit(Args... args)
+    {
+        const unsigned int end = _count;
+        ++_emitting;
+        struct finish
+        {
+            signal& sig;
+            ~finish(void)
+            {
+                if (!--sig._emitting && sig._dirty)
+                {
+                    sig._compact();
+                }
+            }
+        } const finisher{*this};
+        for (unsigned int pos = 0; pos < end; ++pos)
+        {
+            if (_alive[pos])
+            {
+                _slots[pos].get()(static_cast<Args>(args)...);
+            }
+        }
+    }
+
+    void operator()(Args... args) { emit(static_cast<Args>(args)...); }
+
+private:
+    void _erase(unsigned int pos) noexcept
+    {
+        const unsigned int id   = _ids[pos];
+        const unsigned int last = --_count;
+        _slots[pos].destroy();
+        if (pos != last)
+        {
+            _slots[pos].construct(::lib::move(_slots[last].get()));
+            _slots[last].destroy();
+            _ids[pos]             = _ids[last];
+            _alive[pos]           = _alive[last];
+            _positions[_ids[pos]] = pos;
+        }
+        ++_generations[id];
+        _positions[id] = _free;
+        _free          = id;
+    }
+
+    void _compact(void) noexcept
+    {
+        _dirty = false;
+        for (unsigned int pos = _count; pos-- > 0;)
+        {
+            if (!_alive[pos])
+            {
+                _erase(pos);
+            }
+        }
+    }
+};
+}
@@ -0,0 +1,255 @@
+#pragma once
+
+#include "any.h"
+#include "task_slot.h"
+#include <atomic>
+
+namespace lib
+{
+namespace internal
+{
+constexpr size_t _cache_line_size = 64;
+
+template <class F>
+constexpr bool _empty_task(const F& task, true_type) noexcept
+{
+    return (!static_cast<bool>(task));
+}
+
+template <class F>
+constexpr bool _empty_task(const F&, false_type) noexcept
+{
+    return (false);
+}
+
+template <class F>
+constexpr bool _empty_task(const F& task) noexcept
+{
+    return (_empty_task(task, disjunction<is_same<F, nullptr_t>, is_function<remove_pointer_t<F>>,
+                                          is_base_of<_function<void(void)>, F>>{}));
+}
+}
+
+template <size_t CAPACITY, size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class spsc_task_queue
+{
+    static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "CAPACITY must be a power of two");
+
+public:
+    using task_type = function<void(void), SIZE, ALIGN>;
+
+private:
+    using slot_type = internal::_task_slot<task_type>;
+
+    alignas(internal::_cache_line_size) std::atomic<size_t> _head{0};
+    alignas(internal::_cache_line_size) std::atomic<size_t> _tail{0};
+    alignas(internal::_cache_line_size) slot_type _slots[CAPACITY];
+
+public:
+    spsc_task_queue(void) = default;
+    spsc_task_queue(const spsc_task_queue&) = delete;
+    spsc_task_queue& operator=(const spsc_task_queue&) = delete;
+
+    ~spsc_task_queue(void)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        for (size_t head = _head.load(std::memory_order_relaxed); head != tail; ++head)
+        {
+            _slots[head & (CAPACITY - 1)].destroy();
+        }
+    }
+
+    template <class F>
+    bool try_push(F&& task)
+    {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        if (internal::_empty_task<decay_t<F>>(task) || tail - _head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            return (false);
+        }
+        _slots[tail & (CAPACITY - 1)].construct(::lib::forward<F>(task));
+        _tail.store(tail + 1, std::memory_order_release);
+        return (true);
+    }
+
+    bool try_run(void)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return (false);
+        }
+        struct advance
+        {
+            std::atomic<size_t>& head;
+            const size_t         next;
+            ~advance(void) { head.store(next, std::memory_order_release); }
+        } const advancer{_head, head + 1};
+        _slots[head & (CAPACITY - 1)].run_and_destroy();
+        return (true);
+    }
+
+    bool try_pop(task_type& task)
+    {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire))
+        {
+            return (false);
+        }
+        _slots[head & (CAPACITY - 1)].take(task);
+        _head.store(head + 1, std::memory_order_release);
+        return (true);
+    }
+
+    bool empty(void) const noexcept
+    {
+        return (_head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire));
+    }
+};
+
+template <size_t CAPACITY, size_t SIZE, size_t ALIGN = alignof(max_align_t)>
+class mpsc_task_queue
+{
+    static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "CAPACITY must be a power of two");
+
+public:
+    using task_type = function<void(void), SIZE, ALIGN>;
+
+private:
+    struct alignas(internal::_cache_line_size) cell
+    {
+        std::atomic<size_t>             sequence;
+        internal::_task_slot<task_type> slot;
+    };
+
+    alignas(internal::_cache_line_size) size_t _head = 0;
+    alignas(internal::_cache_line_size) std::atomic<size_t> _tail{0};
+    cell _cells[CAPACITY];
+
+public:
+    mpsc_task_queue(void) noexcept
+    {
+        for (size_t i = 0; i < CAPACITY; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+    mpsc_task_queue(const mpsc_task_queue&) = delete;
+    mpsc_task_queue& operator=(const mpsc_task_queue&) = delete;
+
+    ~mpsc_task_queue(void)
+    {
+        while (cell* const c = _front())
+        {
+            c->slot.destroy();
+            _release(*c);
+        }
+    }
+
+    template <class F>
+    bool try_push(F&& task)
+    {
+        if (internal::_empty_task<decay_t<F>>(task))
+        {
+            return (false);
+        }
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            cell&           c    = _cells[tail & (CAPACITY - 1)];
+            const size_t    seq  = c.sequence.load(std::memory_order_acquire);
+            const ptrdiff_t diff = static_cast<ptrdiff_t>(seq - tail);
+            if (diff == 0)
+            {
+                if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                {
+                    struct publish
+                    {
+                        cell&        c;
+                        const size_t sequence;
+                        bool         constructed;
+                        ~publish(void)
+                        {
+                            if (!constructed)
+                            {
+                                c.slot.construct(task_type{});
+                            }
+                            c.sequence.store(sequence, std::memory_order_release);
+                        }
+                    } publisher{c, tail + 1, false};
+                    c.slot.construct(::lib::forward<F>(task));
+                    publisher.constructed = true;
+                    return (true);
+                }
+            }
+            else if (diff < 0)
+            {
+                return (false);
+            }
+            else
+            {
+                tail = _tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool try_run(void)
+    {
+        cell* const c = _front();
+        if (!c)
+        {
+            return (false);
+        }
+        struct release
+        {
+            mpsc_task_queue& queue;
+            cell&            c;
+            ~release(void) { queue._release(c); }
+        } const releaser{*this, *c};
+        c->slot.run_and_destroy();
+        return (true);
+    }
+
+    bool try_pop(task_type& task)
+    {
+        cell* const c = _front();
+        if (!c)
+        {
+            return (false);
+        }
+        c->slot.take(task);
+        _release(*c);
+        return (true);
+    }
+
+    bool empty(void) const noexcept
+    {
+        return (_cells[_head & (CAPACITY - 1)].sequence.load(std::memory_order_acquire) != _head + 1);
+    }
+
+private:
+    cell* _front(void) noexcept
+    {
+        for (;;)
+        {
+            cell& c = _cells[_head & (CAPACITY - 1)];
+            if (c.sequence.load(std::memory_order_acquire) != _head + 1)
+            {
+                return (nullptr);
+            }
+            if (c.slot.get())
+            {
+                return (&c);
+            }
+            c.slot.destroy();
+            _release(c);
+        }
+    }
+
+    void _release(cell& c) noexcept
+    {
+        c.sequence.store(_head + CAPACITY, std::memory_order_release);
+        ++_head;
+    }
+};
+}
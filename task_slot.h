@@ -0,0 +1,44 @@
+#pragma once
+
+#include "type_traits.h"
+#include "new.h"
+
+namespace lib
+{
+namespace internal
+{
+template <class Task>
+class _task_slot
+{
+private:
+    alignas(Task) char _storage[sizeof(Task)];
+
+public:
+    template <class F>
+    void construct(F&& task)
+    {
+        ::new (_storage) Task(::lib::forward<F>(task));
+    }
+
+    Task& get(void) noexcept { return (*reinterpret_cast<Task*>(_storage)); }
+
+    void destroy(void) noexcept { get().~Task(); }
+
+    void run_and_destroy(void)
+    {
+        struct guard
+        {
+            _task_slot& slot;
+            ~guard(void) { slot.destroy(); }
+        } const destroyer{*this};
+        get()();
+    }
+
+    void take(Task& dst)
+    {
+        dst = ::lib::move(get());
+        destroy();
+    }
+};
+}
+}
@@ -0,0 +1,385 @@
+#pragma once
+
+#include "any.h"
+#include "task_queue.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace lib
+{
+namespace internal
+{
+template <class Task, size_t CAPACITY>
+class _chase_lev_deque
+{
+    static_assert(CAPACITY && !(CAPACITY & (CAPACITY - 1)), "CAPACITY must be a power of two");
+
+private:
+    struct cell
+    {
+        std::atomic<bool> full{false};
+        _task_slot<Task>  slot;
+    };
+
+    alignas(_cache_line_size) std::atomic<ptrdiff_t> _top{0};
+    alignas(_cache_line_size) std::atomic<ptrdiff_t> _bottom{0};
+    alignas(_cache_line_size) cell _cells[CAPACITY];
+
+public:
+    _chase_lev_deque(void) = default;
+    _chase_lev_deque(const _chase_lev_deque&) = delete;
+    _chase_lev_deque& operator=(const _chase_lev_deque&) = delete;
+
+    ~_chase_lev_deque(void)
+    {
+        for (auto& c : _cells)
+        {
+            if (c.full.load(std::memory_order_relaxed))
+            {
+                c.slot.destroy();
+            }
+        }
+    }
+
+    template <class F>
+    bool push(F&& task)
+    {
+        const ptrdiff_t b = _bottom.load(std::memory_order_relaxed);
+        const ptrdiff_t t = _top.load(std::memory_order_acquire);
+        cell&           c = _cells[b & (CAPACITY - 1)];
+        if (b - t >= static_cast<ptrdiff_t>(CAPACITY) || c.full.load(std::memory_order_acquire))
+        {
+            return (false);
+        }
+        c.slot.construct(::lib::forward<F>(task));
+        c.full.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return (true);
+    }
+
+    bool run_one(void)
+    {
+        const ptrdiff_t b = _bottom.load(std::memory_order_relaxed) - 1;
+        _bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        ptrdiff_t t = _top.load(std::memory_order_relaxed);
+        if (t > b)
+        {
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            return (false);
+        }
+        if (t == b)
+        {
+            const bool won =
+                _top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            _bottom.store(b + 1, std::memory_order_relaxed);
+            if (!won)
+            {
+                return (false);
+            }
+        }
+        cell& c = _cells[b & (CAPACITY - 1)];
+        struct release
+        {
+            std::atomic<bool>& full;
+            ~release(void) { full.store(false, std::memory_order_release); }
+        } const releaser{c.full};
+        c.slot.run_and_destroy();
+        return (true);
+    }
+
+    bool steal(Task& task)
+    {
+        ptrdiff_t t = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const ptrdiff_t b = _bottom.load(std::memory_order_acquire);
+        if (t >= b)
+        {
+            return (false);
+        }
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        {
+            return (false);
+        }
+        cell& c = _cells[t & (CAPACITY - 1)];
+        c.slot.take(task);
+        c.full.store(false, std::memory_order_release);
+        return (true);
+    }
+};
+}
+
+template <size_t SIZE, size_t ALIGN = alignof(max_align_t), size_t CAPACITY = 1024>
+class thread_pool
+{
+public:
+    using task_type = function<void(void), SIZE, ALIGN>;
+
+private:
+    struct worker
+    {
+        internal::_chase_lev_deque<task_type, CAPACITY> deque;
+        mpsc_task_queue<CAPACITY, SIZE, ALIGN>          inbox;
+        std::mutex                                      inbox_lock;
+        std::thread                                     thread;
+    };
+
+    const size_t            _count;
+    std::unique_ptr<char[]> _storage;
+    worker*                 _workers;
+    std::atomic<size_t>     _next{0};
+    std::atomic<size_t>     _sleeping{0};
+    std::atomic<bool>       _stop{false};
+    std::mutex              _idle_lock;
+    std::condition_variable _idle;
+
+public:
+    explicit thread_pool(size_t threads = std::thread::hardware_concurrency()) :
+        _count(threads ? threads : 1),
+        _storage(new char[sizeof(worker) * _count + alignof(worker)]),
+        _workers(nullptr)
+    {
+        void*       storage = _storage.get();
+        std::size_t space   = sizeof(worker) * _count + alignof(worker);
+        storage             = std::align(alignof(worker), sizeof(worker) * _count, storage, space);
+        _workers            = static_cast<worker*>(storage);
+        struct rollback
+        {
+            thread_pool& pool;
+            size_t       constructed;
+            bool         started;
+            ~rollback(void)
+            {
+                if (!started)
+                {
+                    pool._shutdown(constructed);
+                }
+            }
+        } guard{*this, 0, false};
+        for (; guard.constructed < _count; ++guard.constructed)
+        {
+            ::new (&_workers[guard.constructed]) worker;
+        }
+        for (size_t i = 0; i < _count; ++i)
+        {
+            _workers[i].thread = std::thread([this, i] { _run(i); });
+        }
+        guard.started = true;
+    }
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool(void) { _shutdown(_count); }
+
+    size_t size(void) const noexcept { return (_count); }
+
+    // An exception thrown by a submitted task is discarded by the worker that runs it.
+    template <class F>
+    void submit(F&& task)
+    {
+        static_assert(sizeof(decay_t<F>) <= SIZE, "Task does not fit in the slot size");
+        static_assert(ALIGN % alignof(decay_t<F>) == 0, "Task alignment is incorrect");
+        if (!_push(::lib::forward<F>(task)))
+        {
+            task();
+            return;
+        }
+        if (_sleeping.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock{_idle_lock};
+            _idle.notify_one();
+        }
+    }
+
+    // Rethrows the first exception thrown by func once every chunk has finished.
+    template <class F>
+    void parallel_for(size_t first, size_t last, F&& func, size_t grain = 1)
+    {
+        if (first >= last)
+        {
+            return;
+        }
+        grain                 = grain ? grain : 1;
+        const size_t chunks   = _count * 4;
+        const size_t per_task = ((last - first) / chunks > grain) ? (last - first) / chunks : grain;
+
+        struct
+        {
+            std::atomic<size_t> pending;
+            std::atomic<bool>   failed;
+            std::exception_ptr  error;
+        } state{{(last - first + per_task - 1) / per_task}, {false}, nullptr};
+        for (size_t lo = first; lo < last; lo += per_task)
+        {
+            const size_t hi = (last - lo > per_task) ? lo + per_task : last;
+            submit([&func, &state, lo, hi] {
+                struct complete
+                {
+                    std::atomic<size_t>& pending;
+                    ~complete(void) { pending.fetch_sub(1, std::memory_order_acq_rel); }
+                } const completer{state.pending};
+                try
+                {
+                    for (size_t i = lo; i < hi && !state.failed.load(std::memory_order_relaxed); ++i)
+                    {
+                        func(i);
+                    }
+                }
+                catch (...)
+                {
+                    if (!state.failed.exchange(true, std::memory_order_relaxed))
+                    {
+                        state.error = std::current_exception();
+                    }
+                }
+            });
+        }
+        while (state.pending.load(std::memory_order_acquire))
+        {
+            if (!_help())
+            {
+                std::this_thread::yield();
+            }
+        }
+        if (state.error)
+        {
+            std::rethrow_exception(state.error);
+        }
+    }
+
+private:
+    static thread_pool*& _current_pool(void) noexcept
+    {
+        static thread_local thread_pool* pool = nullptr;
+        return (pool);
+    }
+
+    static size_t& _current_index(void) noexcept
+    {
+        static thread_local size_t index = 0;
+        return (index);
+    }
+
+    bool _is_worker(void) const noexcept { return (_current_pool() == this); }
+
+    template <class F>
+    bool _push(F&& task)
+    {
+        if (_is_worker() && _workers[_current_index()].deque.push(::lib::forward<F>(task)))
+        {
+            return (true);
+        }
+        const size_t start = _next.fetch_add(1, std::memory_order_relaxed);
+        for (size_t i = 0; i < _count; ++i)
+        {
+            if (_workers[(start + i) % _count].inbox.try_push(::lib::forward<F>(task)))
+            {
+                return (true);
+            }
+        }
+        return (false);
+    }
+
+    void _shutdown(size_t constructed) noexcept
+    {
+        _stop.store(true, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock{_idle_lock};
+            _idle.notify_all();
+        }
+        for (size_t i = 0; i < constructed; ++i)
+        {
+            if (_workers[i].thread.joinable())
+            {
+                _workers[i].thread.join();
+            }
+        }
+        for (size_t i = 0; i < constructed; ++i)
+        {
+            _workers[i].~worker();
+        }
+    }
+
+    bool _help(void) noexcept
+    {
+        try
+        {
+            return (_run_one());
+        }
+        catch (...)
+        {
+            return (true);
+        }
+    }
+
+    bool _run_one(void)
+    {
+        const size_t self = _is_worker() ? _current_index() : 0;
+        if (_is_worker() && _workers[self].deque.run_one())
+        {
+            return (true);
+        }
+        if (_is_worker())
+        {
+            std::unique_lock<std::mutex> lock{_workers[self].inbox_lock, std::try_to_lock};
+            if (lock && _workers[self].inbox.try_run())
+            {
+                return (true);
+            }
+        }
+        task_type task;
+        for (size_t i = 1; i <= _count; ++i)
+        {
+            auto& victim = _workers[(self + i) % _count];
+            if (victim.deque.steal(task))
+            {
+                task();
+                return (true);
+            }
+            std::unique_lock<std::mutex> lock{victim.inbox_lock, std::try_to_lock};
+            if (lock && victim.inbox.try_pop(task))
+            {
+                lock.unlock();
+                task();
+                return (true);
+            }
+        }
+        return (false);
+    }
+
+    void _run(size_t index)
+    {
+        _current_pool()  = this;
+        _current_index() = index;
+
+        size_t idle = 0;
+        while (!_stop.load(std::memory_order_acquire))
+        {
+            if (_help())
+            {
+                idle = 0;
+            }
+            else if (++idle < 64)
+            {
+                std::this_thread::yield();
+            }
+            else
+            {
+                _sleeping.fetch_add(1, std::memory_order_acq_rel);
+                std::unique_lock<std::mutex> lock{_idle_lock};
+                _idle.wait_for(lock, std::chrono::milliseconds(1));
+                _sleeping.fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+        while (_help())
+        {
+        }
+    }
+};
+}
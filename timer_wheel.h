@@ -0,0 +1,244 @@
+#pragma once
+
+#include "any.h"
+#include "task_slot.h"
+
+namespace lib
+{
+struct timer_handle
+{
+    unsigned int index      = ~0u;
+    unsigned int generation = 0;
+};
+
+template <size_t SIZE, size_t CAPACITY, size_t ALIGN = alignof(max_align_t)>
+class timer_wheel
+{
+    static_assert(CAPACITY < ~0u, "CAPACITY is too large");
+
+public:
+    using callback_type = function<void(void), SIZE, ALIGN>;
+    using tick_type     = unsigned long long;
+
+private:
+    static constexpr unsigned int LEVEL_BITS   = 6;
+    static constexpr unsigned int LEVEL_SLOTS  = 1u << LEVEL_BITS;
+    static constexpr unsigned int LEVELS       = 4;
+    static constexpr unsigned int EXPIRING     = LEVELS * LEVEL_SLOTS;
+    static constexpr unsigned int BUCKET_COUNT = EXPIRING + 1;
+    static constexpr unsigned int NONE         = ~0u;
+
+    struct node
+    {
+        internal::_task_slot<callback_type> callback;
+        tick_type                           expires;
+        unsigned int                        prev;
+        unsigned int                        next;
+        unsigned int                        bucket;
+        unsigned int                        generation;
+    };
+
+    node         _nodes[CAPACITY];
+    unsigned int _buckets[BUCKET_COUNT];
+    unsigned int _free;
+    size_t       _size = 0;
+    tick_type    _now  = 0;
+
+public:
+    timer_wheel(void) noexcept : _free(CAPACITY ? 0 : NONE)
+    {
+        for (auto& bucket : _buckets)
+        {
+            bucket = NONE;
+        }
+        for (unsigned int i = 0; i < CAPACITY; ++i)
+        {
+            _nodes[i].next       = (i + 1 < CAPACITY) ? i + 1 : NONE;
+            _nodes[i].bucket     = NONE;
+            _nodes[i].generation = 0;
+        }
+    }
+    timer_wheel(const timer_wheel&) = delete;
+    timer_wheel& operator=(const timer_wheel&) = delete;
+
+    ~timer_wheel(void)
+    {
+        for (auto& n : _nodes)
+        {
+            if (n.bucket != NONE)
+            {
+                n.callback.destroy();
+            }
+        }
+    }
+
+    tick_type now(void) const noexcept { return (_now); }
+    size_t    size(void) const noexcept { return (_size); }
+    bool      full(void) const noexcept { return (_free == NONE); }
+
+    template <class F>
+    timer_handle schedule(tick_type delay, F&& callback)
+    {
+        timer_handle handle;
+        if (_free == NONE)
+        {
+            return (handle);
+        }
+        const unsigned int index = _free;
+        node&              n     = _nodes[index];
+        n.callback.construct(::lib::forward<F>(callback));
+        _free     = n.next;
+        n.expires = _now + (delay ? delay : 1);
+        _insert(index);
+        ++_size;
+        handle.index      = index;
+        handle.generation = n.generation;
+        return (handle);
+    }
+
+    bool cancel(timer_handle handle) noexcept
+    {
+        if (!active(handle))
+        {
+            return (false);
+        }
+        _unlink(handle.index);
+        _nodes[handle.index].callback.destroy();
+        _release(handle.index);
+        return (true);
+    }
+
+    bool active(timer_handle handle) const noexcept
+    {
+        return (handle.index < CAPACITY && _nodes[handle.index].generation == handle.generation &&
+                _nodes[handle.index].bucket != NONE);
+    }
+
+    size_t advance(tick_type ticks = 1)
+    {
+        size_t fired = 0;
+        for (; ticks; --ticks)
+        {
+            fired += _tick();
+        }
+        return (fired);
+    }
+
+private:
+    static unsigned int _slot(tick_type ticks, unsigned int level) noexcept
+    {
+        return (static_cast<unsigned int>(ticks >> (level * LEVEL_BITS)) & (LEVEL_SLOTS - 1));
+    }
+
+    unsigned int _bucket_of(tick_type expires) const noexcept
+    {
+        for (unsigned int level = 0; level < LEVELS; ++level)
+        {
+            const unsigned int upper = (level + 1) * LEVEL_BITS;
+            if ((expires >> upper) == (_now >> upper))
+            {
+                return (level * LEVEL_SLOTS + _slot(expires, level));
+            }
+        }
+        constexpr unsigned int top   = LEVELS - 1;
+        const unsigned int     shift = top * LEVEL_BITS;
+        if ((expires >> shift) - (_now >> shift) < LEVEL_SLOTS)
+        {
+            return (top * LEVEL_SLOTS + _slot(expires, top));
+        }
+        return (top * LEVEL_SLOTS + ((_slot(_now, top) + LEVEL_SLOTS - 1) & (LEVEL_SLOTS - 1)));
+    }
+
+    void _link(unsigned int index, unsigned int bucket) noexcept
+    {
+        node& n  = _nodes[index];
+        n.bucket = bucket;
+        n.prev   = NONE;
+        n.next   = _buckets[bucket];
+        if (n.next != NONE)
+        {
+            _nodes[n.next].prev = index;
+        }
+        _buckets[bucket] = index;
+    }
+
+    void _insert(unsigned int index) noexcept { _link(index, _bucket_of(_nodes[index].expires)); }
+
+    void _unlink(unsigned int index) noexcept
+    {
+        node& n = _nodes[index];
+        if (n.prev != NONE)
+        {
+            _nodes[n.prev].next = n.next;
+        }
+        else
+        {
+            _buckets[n.bucket] = n.next;
+        }
+        if (n.next != NONE)
+        {
+            _nodes[n.next].prev = n.prev;
+        }
+        n.bucket = NONE;
+    }
+
+    void _release(unsigned int index) noexcept
+    {
+        node& n = _nodes[index];
+        ++n.generation;
+        n.next = _free;
+        _free  = index;
+        --_size;
+    }
+
+    void _cascade(unsigned int bucket) noexcept
+    {
+        unsigned int index = _buckets[bucket];
+        _buckets[bucket]   = NONE;
+        while (index != NONE)
+        {
+            const unsigned int next = _nodes[index].next;
+            _insert(index);
+            index = next;
+        }
+    }
+
+    size_t _tick(void)
+    {
+        ++_now;
+        unsigned int top = 0;
+        while (top + 1 < LEVELS && _slot(_now, top) == 0)
+        {
+            ++top;
+        }
+        for (unsigned int level = top; level > 0; --level)
+        {
+            _cascade(level * LEVEL_SLOTS + _slot(_now, level));
+        }
+
+        const unsigned int bucket = _slot(_now, 0);
+        _buckets[EXPIRING]        = _buckets[bucket];
+        _buckets[bucket]          = NONE;
+        for (unsigned int index = _buckets[EXPIRING]; index != NONE; index = _nodes[index].next)
+        {
+            _nodes[index].bucket = EXPIRING;
+        }
+
+        size_t fired = 0;
+        while (_buckets[EXPIRING] != NONE)
+        {
+            const unsigned int index = _buckets[EXPIRING];
+            _unlink(index);
+            struct release
+            {
+                timer_wheel&       wheel;
+                const unsigned int index;
+                ~release(void) { wheel._release(index); }
+            } const releaser{*this, index};
+            _nodes[index].callback.run_and_destroy();
+            ++fired;
+        }
+        return (fired);
+    }
+};
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "type_id.h"
+
+namespace lib
+{
+enum class trace_operation
+{
+    Delete,
+    Copy,
+    Move,
+};
+
+using trace_hook_type = void (*)(const char* type_name, trace_operation ope, const void* object);
+
+struct operation_counter;
+
+namespace internal
+{
+inline operation_counter*& _trace_head(void) noexcept
+{
+    static thread_local operation_counter* head = nullptr;
+    return (head);
+}
+
+inline trace_hook_type& _trace_hook(void) noexcept
+{
+    static thread_local trace_hook_type hook = nullptr;
+    return (hook);
+}
+}
+
+struct operation_counter
+{
+    const char*              type_name;
+    size_t                   copy    = 0;
+    size_t                   move    = 0;
+    size_t                   destroy = 0;
+    operation_counter* const next;
+
+    explicit operation_counter(const char* name) noexcept : type_name(name), next(internal::_trace_head())
+    {
+        internal::_trace_head() = this;
+    }
+    operation_counter(const operation_counter&) = delete;
+    operation_counter& operator=(const operation_counter&) = delete;
+};
+
+namespace internal
+{
+template <class T>
+operation_counter& _trace_counter(void) noexcept
+{
+    static thread_local operation_counter counter{type_name<T>()};
+    return (counter);
+}
+
+struct _trace_disabled
+{
+    static constexpr bool enabled = false;
+
+    template <class T>
+    static void record(trace_operation, const void*) noexcept
+    {}
+};
+
+struct _trace_enabled
+{
+    static constexpr bool enabled = true;
+
+    template <class T>
+    static void record(trace_operation ope, const void* object) noexcept
+    {
+        auto& counter = _trace_counter<T>();
+        switch (ope)
+        {
+        case trace_operation::Delete:
+            ++counter.destroy;
+            break;
+        case trace_operation::Copy:
+            ++counter.copy;
+            break;
+        case trace_operation::Move:
+            ++counter.move;
+            break;
+        default:
+            break;
+        }
+        if (auto hook = _trace_hook())
+        {
+            hook(counter.type_name, ope, object);
+        }
+    }
+};
+
+#ifdef LIB_ENABLE_TRACE
+using _trace_policy = _trace_enabled;
+#else
+using _trace_policy = _trace_disabled;
+#endif
+}
+
+inline trace_hook_type set_trace_hook(trace_hook_type hook) noexcept
+{
+    const trace_hook_type prev = internal::_trace_hook();
+    internal::_trace_hook()    = hook;
+    return (prev);
+}
+
+template <class Func>
+void for_each_operation_counter(Func&& func)
+{
+    for (const auto* counter = internal::_trace_head(); counter; counter = counter->next)
+    {
+        func(*counter);
+    }
+}
+
+inline void reset_operation_counters(void) noexcept
+{
+    for (auto* counter = internal::_trace_head(); counter; counter = counter->next)
+    {
+        counter->copy    = 0;
+        counter->move    = 0;
+        counter->destroy = 0;
+    }
+}
+}
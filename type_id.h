@@ -0,0 +1,123 @@
+#pragma once
+
+#include "hash.h"
+
+#define LIB_DECLARE_STABLE_TYPE_ID(T)    \
+    namespace lib                        \
+    {                                    \
+    template <>                          \
+    struct stable_type_id<T> : true_type \
+    {};                                  \
+    }
+
+namespace lib
+{
+using type_id_t = size_t;
+
+namespace internal
+{
+template <class T>
+constexpr const char* _type_signature(void) noexcept
+{
+#ifdef _MSC_VER
+    return (__FUNCSIG__);
+#else
+    return (__PRETTY_FUNCTION__);
+#endif
+}
+
+constexpr size_t _signature_length(const char* signature) noexcept
+{
+    size_t length = 0;
+    while (signature[length])
+    {
+        ++length;
+    }
+    return (length);
+}
+
+constexpr size_t _type_name_begin(const char* signature) noexcept
+{
+    size_t begin = 0;
+#ifdef _MSC_VER
+    while (signature[begin] && signature[begin] != '<')
+    {
+        ++begin;
+    }
+    return (signature[begin] ? begin + 1 : 0);
+#else
+    while (signature[begin] && !(signature[begin] == '=' && signature[begin + 1] == ' '))
+    {
+        ++begin;
+    }
+    return (signature[begin] ? begin + 2 : 0);
+#endif
+}
+
+constexpr size_t _type_name_end(const char* signature) noexcept
+{
+#ifdef _MSC_VER
+    constexpr char terminator = '>';
+#else
+    constexpr char terminator = ']';
+#endif
+    size_t end = _signature_length(signature);
+    while (end && signature[end - 1] != terminator)
+    {
+        --end;
+    }
+    return (end ? end - 1 : _signature_length(signature));
+}
+
+template <class T, class... Ts>
+using _is_one_of = disjunction<is_same<remove_cv_t<T>, Ts>...>;
+
+template <class T>
+using _is_fundamental = _is_one_of<T, void, nullptr_t, bool, char, signed char, unsigned char, wchar_t, char16_t,
+                                   char32_t, short, unsigned short, int, unsigned int, long, unsigned long, long long,
+                                   unsigned long long, float, double, long double>;
+
+template <class T>
+struct _type_name_storage
+{
+    static constexpr size_t begin  = _type_name_begin(_type_signature<T>());
+    static constexpr size_t length = _type_name_end(_type_signature<T>()) - begin;
+
+    char value[length + 1]{};
+
+    constexpr _type_name_storage(void) noexcept
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            value[i] = _type_signature<T>()[begin + i];
+        }
+    }
+};
+
+template <class T>
+struct _type_id_constant :
+    integral_constant<type_id_t, calc_fnv1a_hash(_type_signature<T>() + _type_name_storage<T>::begin,
+                                                 _type_name_storage<T>::length - 1)>
+{};
+}
+
+// With LIB_STABLE_TYPE_ID, an any built in another binary is matched by type name only for types that opt in here,
+// either by specialisation or with LIB_DECLARE_STABLE_TYPE_ID at global scope. Closure, local and anonymous-namespace
+// types share names across scopes and binaries and must not opt in.
+template <class T>
+struct stable_type_id : internal::_is_fundamental<T>
+{};
+
+template <class T>
+constexpr type_id_t type_id(void) noexcept
+{
+    return (internal::_type_id_constant<T>::value);
+}
+
+template <class T>
+const char* type_name(void) noexcept
+{
+    static constexpr internal::_type_name_storage<T> name{};
+    return (name.value);
+}
+}
@@ -297,6 +297,27 @@ struct add_pointer : internal::_add_pointer<T>
 template <class T>
 using add_pointer_t = typename add_pointer<T>::type;
 
+template <class T>
+struct remove_pointer
+{
+    using type = T;
+};
+
+template <class T>
+struct remove_pointer<T*>
+{
+    using type = T;
+};
+
+template <class T>
+struct remove_pointer<T* const>
+{
+    using type = T;
+};
+
+template <class T>
+using remove_pointer_t = typename remove_pointer<T>::type;
+
 template <class T>
 struct add_const
 {
@@ -338,6 +359,24 @@ struct _is_constructible<void_t<decltype(T(declval<Args>()...))>, T, Args...> :
 template <class T, class... Args>
 using is_constructible = internal::_is_constructible<void, T, Args...>;
 
+namespace internal
+{
+template <class, class T, class... Args>
+struct _is_nothrow_constructible : false_type
+{};
+
+template <class T, class... Args>
+struct _is_nothrow_constructible<void_t<decltype(T(declval<Args>()...))>, T, Args...> :
+    bool_constant<noexcept(T(declval<Args>()...))>
+{};
+}
+
+template <class T, class... Args>
+using is_nothrow_constructible = internal::_is_nothrow_constructible<void, T, Args...>;
+
+template <class T>
+using is_nothrow_move_constructible = is_nothrow_constructible<T, add_rvalue_reference_t<T>>;
+
 template <class T, class U>
 struct is_same : false_type
 {};
@@ -366,6 +405,14 @@ template <class T>
 struct is_reference<T&&> : true_type
 {};
 
+template <class T>
+struct is_lvalue_reference : false_type
+{};
+
+template <class T>
+struct is_lvalue_reference<T&> : true_type
+{};
+
 template <class T>
 struct is_function : negation<disjunction<is_const<const T>, is_reference<T>>>
 {};
@@ -390,6 +437,52 @@ template <class T>
 struct is_object : negation<disjunction<is_function<T>, is_reference<T>, is_void<T>>>
 {};
 
+template <class T>
+struct is_empty : bool_constant<__is_empty(T)>
+{};
+
+template <class T>
+struct is_trivially_copyable : bool_constant<__is_trivially_copyable(T)>
+{};
+
+template <class T>
+struct is_trivially_default_constructible : bool_constant<__is_trivially_constructible(T)>
+{};
+
+template <class T>
+struct is_trivially_destructible :
+#if defined(__clang__) || defined(_MSC_VER)
+    bool_constant<__is_trivially_destructible(T)>
+#else
+    bool_constant<__has_trivial_destructor(T)>
+#endif
+{};
+
+template <class T>
+struct has_unique_object_representations : bool_constant<__has_unique_object_representations(T)>
+{};
+
+template <class Base, class Derived>
+struct is_base_of : bool_constant<__is_base_of(Base, Derived)>
+{};
+
+namespace internal
+{
+template <class To>
+void _implicit_convert(To) noexcept;
+
+template <class, class From, class To>
+struct _is_convertible : false_type
+{};
+
+template <class From, class To>
+struct _is_convertible<void_t<decltype(_implicit_convert<To>(declval<From>()))>, From, To> : true_type
+{};
+}
+
+template <class From, class To>
+using is_convertible = internal::_is_convertible<void, From, To>;
+
 template <class, class>
 struct is_same_template : false_type
 {};
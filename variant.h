@@ -2,6 +2,8 @@
 
 #include "type_traits.h"
 #include "new.h"
+#include "trace.h"
+#include "hash.h"
 
 namespace lib
 {
@@ -88,6 +90,7 @@ struct _visit_copier
     template <class T>
     void operator()(const T& src) const
     {
+        _trace_policy::record<decay_t<T>>(trace_operation::Copy, dst);
         new (dst) decay_t<T>(src);
     }
 };
@@ -97,7 +100,8 @@ struct _visit_mover
     template <class T>
     void operator()(T&& src) const
     {
-        new (dst) decay_t<T>(move(src));
+        _trace_policy::record<decay_t<T>>(trace_operation::Move, dst);
+        new (dst) decay_t<T>(::lib::move(src));
     }
 };
 struct _visit_destructor
@@ -106,6 +110,7 @@ struct _visit_destructor
     void operator()(T&& dst) const
     {
         using Decayed = decay_t<T>;
+        _trace_policy::record<Decayed>(trace_operation::Delete, &dst);
         dst.~Decayed();
     }
 };
@@ -115,113 +120,290 @@ constexpr _visit_destructor _visit_destructor_v;
 template <class Visitor, class... Variants>
 internal::_visit_result_t<Visitor, Variants...> visit(Visitor&& vis, Variants&&... vars);
 
+namespace internal
+{
+template <size_t Index>
+struct _union_index
+{};
+
+template <bool Trivial, class... Ts>
+union _variant_union;
+
+template <bool Trivial>
+union _variant_union<Trivial>
+{};
+
+template <class First, class... Next>
+union _variant_union<true, First, Next...>
+{
+    char                          none;
+    First                         head;
+    _variant_union<true, Next...> tail;
+
+    constexpr _variant_union(void) noexcept : none() {}
+
+    template <class... Args>
+    constexpr _variant_union(_union_index<0>, Args&&... args) : head(::lib::forward<Args>(args)...)
+    {}
+
+    template <size_t Index, class... Args>
+    constexpr _variant_union(_union_index<Index>, Args&&... args) :
+        tail(_union_index<Index - 1>{}, ::lib::forward<Args>(args)...)
+    {}
+};
+
+template <class First, class... Next>
+union _variant_union<false, First, Next...>
+{
+    char                           none;
+    First                          head;
+    _variant_union<false, Next...> tail;
+
+    constexpr _variant_union(void) noexcept : none() {}
+
+    template <class... Args>
+    constexpr _variant_union(_union_index<0>, Args&&... args) : head(::lib::forward<Args>(args)...)
+    {}
+
+    template <size_t Index, class... Args>
+    constexpr _variant_union(_union_index<Index>, Args&&... args) :
+        tail(_union_index<Index - 1>{}, ::lib::forward<Args>(args)...)
+    {}
+
+    ~_variant_union(void) {}
+};
+
+template <size_t Index>
+struct _union_access
+{
+    template <class Union>
+    static constexpr auto& get(Union& storage) noexcept
+    {
+        return (_union_access<Index - 1>::get(storage.tail));
+    }
+};
+
+template <>
+struct _union_access<0>
+{
+    template <class Union>
+    static constexpr auto& get(Union& storage) noexcept
+    {
+        return (storage.head);
+    }
+};
+
+template <class T>
+void _variant_destroy(void* storage)
+{
+    _visit_destructor_v(*static_cast<T*>(storage));
+}
+
+template <class... Ts>
+using _variant_trivial = conjunction<is_trivially_destructible<Ts>...>;
+
+template <class... Ts>
+class _variant_storage
+{
+protected:
+    static constexpr size_t _npos = ~size_t(0);
+
+    _variant_union<_variant_trivial<Ts...>::value, Ts...> _storage;
+    size_t                                                 _current_id;
+
+    constexpr _variant_storage(void) noexcept : _storage(), _current_id(_npos) {}
+
+    template <size_t Index, class... Args>
+    constexpr _variant_storage(_union_index<Index>, Args&&... args) :
+        _storage(_union_index<Index>{}, ::lib::forward<Args>(args)...), _current_id(Index)
+    {}
+
+    void _destroy(void)
+    {
+        constexpr void (*vtable[])(void*) = {_variant_destroy<Ts>...};
+        if (_current_id != _npos)
+        {
+            vtable[_current_id](&_storage);
+            _current_id = _npos;
+        }
+    }
+};
+
+template <bool Trivial, class... Ts>
+class _variant_base : public _variant_storage<Ts...>
+{
+protected:
+    using _variant_storage<Ts...>::_variant_storage;
+};
+
 template <class... Ts>
-class variant
+class _variant_base<false, Ts...> : public _variant_storage<Ts...>
+{
+protected:
+    using _variant_storage<Ts...>::_variant_storage;
+
+    ~_variant_base(void) { this->_destroy(); }
+};
+}
+
+template <class... Ts>
+class variant : private internal::_variant_base<internal::_variant_trivial<Ts...>::value, Ts...>
 {
     static_assert(!disjunction<is_array<Ts>...>::value, "Array cannot be used.");
     static_assert(conjunction<is_object<Ts>...>::value, "T params must be object.");
 
+    using base = internal::_variant_base<internal::_variant_trivial<Ts...>::value, Ts...>;
+
 public:
     template <class T>
     using type_to_index = typename internal::_type_to_index<T, variant>;
 
-private:
-    alignas(Ts...) char _buffer[largest<Ts...>::SIZE]{};
-    size_t _current_id;
-
 public:
-    variant(void) : _current_id(0)
+    constexpr variant(void) : base(internal::_union_index<0>{})
     {
         using T = variant_alternative_t<0, variant>;
         static_assert(is_constructible<T>::value, "First T param is not constructible by default.");
-        new (_buffer) T;
     }
-    variant(const variant& rhs) : _current_id(rhs._current_id)
+    variant(const variant& rhs) : base()
     {
         copy(rhs);
+        this->_current_id = rhs._current_id;
     }
-    variant(variant&& rhs) : _current_id(rhs._current_id) { move(::lib::move(rhs)); }
-
-    template <class T, disable_if_t<disjunction<is_template_of<variant, decay_t<T>>>::value>* = nullptr>
-    variant(T&& data) : _current_id(type_to_index<remove_cvref_t<T>>::value)
+    variant(variant&& rhs) : base()
     {
-        new (_buffer) remove_cvref_t<T>{forward<T>(data)};
+        move(::lib::move(rhs));
+        this->_current_id = rhs._current_id;
     }
 
+    template <class T, disable_if_t<disjunction<is_template_of<variant, decay_t<T>>>::value>* = nullptr>
+    constexpr variant(T&& data) :
+        base(internal::_union_index<type_to_index<remove_cvref_t<T>>::value>{}, ::lib::forward<T>(data))
+    {}
+
     variant& operator=(const variant& rhs)
     {
-        destroy();
-        _current_id = rhs._current_id;
-        copy(rhs);
+        if (this != &rhs)
+        {
+            _assign(rhs._current_id, [this, &rhs](void) { copy(rhs); });
+        }
         return (*this);
     }
     variant& operator=(variant&& rhs)
     {
-        destroy();
-        _current_id = rhs._current_id;
-        move(::lib::move(rhs));
+        if (this != &rhs)
+        {
+            _assign(rhs._current_id, [this, &rhs](void) { move(::lib::move(rhs)); });
+        }
         return (*this);
     }
     template <class T, disable_if_t<disjunction<is_template_of<variant, decay_t<T>>>::value>* = nullptr>
     variant& operator=(T&& data)
     {
-        destroy();
-        _current_id = type_to_index<remove_cvref_t<T>>::value;
-        new (_buffer) remove_cvref_t<T>{forward<T>(data)};
+        using U = remove_cvref_t<T>;
+        U value{::lib::forward<T>(data)};
+        _assign(type_to_index<U>::value, [this, &value](void) { new (_get_buffer()) U{::lib::move(value)}; });
         return (*this);
     }
 
-    ~variant(void) { destroy(); }
+    constexpr size_t index(void) const noexcept { return (this->_current_id); }
 
-    constexpr size_t index(void) const noexcept { return (_current_id); }
+    void*       _get_buffer(void) { return (&this->_storage); }
+    const void* _get_buffer(void) const { return (&this->_storage); }
 
-    void*       _get_buffer(void) { return (_buffer); }
-    const void* _get_buffer(void) const { return (_buffer); }
+    constexpr auto&       _get_union(void) noexcept { return (this->_storage); }
+    constexpr const auto& _get_union(void) const noexcept { return (this->_storage); }
+
+    template <class Constructor>
+    bool _construct_with(size_t index, Constructor&& construct)
+    {
+        destroy();
+        fallback guard{this};
+        if (index < sizeof...(Ts) && construct(_get_buffer()))
+        {
+            guard.target      = nullptr;
+            this->_current_id = index;
+            return (true);
+        }
+        return (false);
+    }
 
 private:
+    // A failed assignment leaves the first alternative behind when that cannot throw, and the valueless
+    // state otherwise.
+    struct fallback
+    {
+        variant* target;
+
+        ~fallback(void)
+        {
+            if (target)
+            {
+                _recover(*target, is_nothrow_constructible<variant_alternative_t<0, variant>>{});
+            }
+        }
+    };
+
+    static void _recover(variant& target, true_type) noexcept
+    {
+        new (target._get_buffer()) variant_alternative_t<0, variant>();
+        target._current_id = 0;
+    }
+
+    static void _recover(variant&, false_type) noexcept {}
+
+    template <class Func>
+    void _assign(size_t index, Func&& func)
+    {
+        destroy();
+        fallback guard{this};
+        func();
+        guard.target      = nullptr;
+        this->_current_id = index;
+    }
+
     void copy(const variant& src)
     {
-        visit(internal::_visit_copier{_buffer}, src);
+        if (src._current_id != this->_npos)
+        {
+            visit(internal::_visit_copier{_get_buffer()}, src);
+        }
     }
     void move(variant&& src)
     {
-        visit(internal::_visit_mover{_buffer}, src);
+        if (src._current_id != this->_npos)
+        {
+            visit(internal::_visit_mover{_get_buffer()}, src);
+        }
     }
-    void destroy(void) { visit(internal::_visit_destructor_v, *this); }
+    void destroy(void) { this->_destroy(); }
 };
 
 template <size_t Index, class... Ts>
 constexpr add_pointer_t<variant_alternative_t<Index, variant<Ts...>>> get_if(variant<Ts...>* v) noexcept
 {
-    using R = add_pointer_t<variant_alternative_t<Index, variant<Ts...>>>;
     static_assert(Index < sizeof...(Ts), "Index is out of bounds.");
-    return ((v && v->index() == Index) ? static_cast<R>(v->_get_buffer()) : nullptr);
+    return ((v && v->index() == Index) ? &internal::_union_access<Index>::get(v->_get_union()) : nullptr);
 }
 
 template <size_t Index, class... Ts>
 constexpr add_pointer_t<const variant_alternative_t<Index, variant<Ts...>>> get_if(const variant<Ts...>* v) noexcept
 {
-    using R = add_pointer_t<const variant_alternative_t<Index, variant<Ts...>>>;
     static_assert(Index < sizeof...(Ts), "Index is out of bounds.");
-    return ((v && v->index() == Index) ? static_cast<R>(v->_get_buffer()) : nullptr);
+    return ((v && v->index() == Index) ? &internal::_union_access<Index>::get(v->_get_union()) : nullptr);
 }
 
 template <class T, class... Ts>
 constexpr add_pointer_t<T> get_if(variant<Ts...>* v) noexcept
 {
-    using R = add_pointer_t<T>;
     static_assert(internal::_type_duple_count<T, variant<Ts...>>::value == 1, "variant tparam must have one T.");
-    return ((v && v->index() == internal::_type_to_index<T, variant<Ts...>>::value) ? static_cast<R>(v->_get_buffer())
-                                                                                    : nullptr);
+    return (get_if<internal::_type_to_index<T, variant<Ts...>>::value>(v));
 }
 
 template <class T, class... Ts>
 constexpr add_pointer_t<const T> get_if(const variant<Ts...>* v) noexcept
 {
-    using R = add_pointer_t<const T>;
     static_assert(internal::_type_duple_count<T, variant<Ts...>>::value == 1, "variant tparam must have one T.");
-    return ((v && v->index() == internal::_type_to_index<T, variant<Ts...>>::value) ? static_cast<R>(v->_get_buffer())
-                                                                                    : nullptr);
+    return (get_if<internal::_type_to_index<T, variant<Ts...>>::value>(v));
 }
 
 template <size_t Index, class... Ts>
@@ -233,7 +415,7 @@ constexpr variant_alternative_t<Index, variant<Ts...>>& get(variant<Ts...>& v)
 template <size_t Index, class... Ts>
 constexpr variant_alternative_t<Index, variant<Ts...>>&& get(variant<Ts...>&& v)
 {
-    return (move(*get_if<Index>(&v)));
+    return (::lib::move(*get_if<Index>(&v)));
 }
 
 template <size_t Index, class... Ts>
@@ -245,7 +427,7 @@ constexpr const variant_alternative_t<Index, variant<Ts...>>& get(const variant<
 template <size_t Index, class... Ts>
 constexpr const variant_alternative_t<Index, variant<Ts...>>&& get(const variant<Ts...>&& v)
 {
-    return (move(*get_if<Index>(&v)));
+    return (::lib::move(*get_if<Index>(&v)));
 }
 
 template <class T, class... Ts>
@@ -257,7 +439,7 @@ constexpr T& get(variant<Ts...>& v)
 template <class T, class... Ts>
 constexpr T&& get(variant<Ts...>&& v)
 {
-    return (move(*get_if<T>(&v)));
+    return (::lib::move(*get_if<T>(&v)));
 }
 
 template <class T, class... Ts>
@@ -269,7 +451,7 @@ constexpr const T& get(const variant<Ts...>& v)
 template <class T, class... Ts>
 constexpr const T&& get(const variant<Ts...>&& v)
 {
-    return (move(*get_if<T>(&v)));
+    return (::lib::move(*get_if<T>(&v)));
 }
 
 namespace internal
@@ -277,14 +459,14 @@ namespace internal
 template <class R, class Visitor, class Variants, size_t Index>
 static R _visit_vtable(Visitor&& vis, Variants&& vars)
 {
-    return (forward<Visitor>(vis)(get<Index>(forward<Variants>(vars))));
+    return (::lib::forward<Visitor>(vis)(get<Index>(::lib::forward<Variants>(vars))));
 }
 
 template <class R, class Visitor, class Variants, size_t... Indices>
 static R _visit_impl(Visitor&& vis, Variants&& vars, index_sequence<Indices...>)
 {
     constexpr R (*vtable[])(Visitor&&, Variants &&) = {_visit_vtable<R, Visitor, Variants, Indices>...};
-    return (vtable[vars.index()](forward<Visitor>(vis), forward<Variants>(vars)));
+    return (vtable[vars.index()](::lib::forward<Visitor>(vis), ::lib::forward<Variants>(vars)));
 }
 }
 
@@ -292,14 +474,109 @@ template <class Visitor, class... Variants>
 internal::_visit_result_t<Visitor, Variants...> visit(Visitor&& vis, Variants&&... vars)
 {
     using R = internal::_visit_result_t<Visitor, Variants...>;
-    return (internal::_visit_impl<R>(forward<Visitor>(vis), forward<Variants>(vars)...,
+    return (internal::_visit_impl<R>(::lib::forward<Visitor>(vis), ::lib::forward<Variants>(vars)...,
                               make_index_sequence<variant_size<remove_cvref_t<Variants>>::value>{}...));
 }
 
 template <class R, class Visitor, class... Variants>
 R visit(Visitor&& vis, Variants&&... vars)
 {
-    return (internal::_visit_impl<R>(forward<Visitor>(vis), forward<Variants>(vars)...,
+    return (internal::_visit_impl<R>(::lib::forward<Visitor>(vis), ::lib::forward<Variants>(vars)...,
                               make_index_sequence<variant_size<remove_cvref_t<Variants>>::value>{}...));
 }
+
+namespace internal
+{
+struct _variant_equal
+{
+    template <class T>
+    bool operator()(const T& lhs, const T& rhs) const
+    {
+        return (lhs == rhs);
+    }
+};
+struct _variant_less
+{
+    template <class T>
+    bool operator()(const T& lhs, const T& rhs) const
+    {
+        return (lhs < rhs);
+    }
+};
+
+template <class Compare, class Variant, size_t Index>
+bool _compare_alternative(const Variant& lhs, const Variant& rhs)
+{
+    return (Compare{}(get<Index>(lhs), get<Index>(rhs)));
+}
+
+template <class Compare, class... Ts, size_t... Indices>
+bool _compare_impl(const variant<Ts...>& lhs, const variant<Ts...>& rhs, index_sequence<Indices...>)
+{
+    constexpr bool (*vtable[])(const variant<Ts...>&, const variant<Ts...>&) = {
+        _compare_alternative<Compare, variant<Ts...>, Indices>...};
+    return (vtable[lhs.index()](lhs, rhs));
+}
+
+template <class Variant, size_t Index>
+size_t _hash_alternative(const Variant& value)
+{
+    return (hash<variant_alternative_t<Index, Variant>>{}(get<Index>(value)));
+}
+
+template <class... Ts, size_t... Indices>
+size_t _hash_impl(const variant<Ts...>& value, index_sequence<Indices...>)
+{
+    constexpr size_t (*vtable[])(const variant<Ts...>&) = {_hash_alternative<variant<Ts...>, Indices>...};
+    return (_hash_combine(value.index(), vtable[value.index()](value)));
+}
+}
+
+template <class... Ts>
+bool operator==(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return (lhs.index() == rhs.index() &&
+            internal::_compare_impl<internal::_variant_equal>(lhs, rhs, make_index_sequence<sizeof...(Ts)>{}));
+}
+
+template <class... Ts>
+bool operator!=(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return (!(lhs == rhs));
+}
+
+template <class... Ts>
+bool operator<(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return ((lhs.index() != rhs.index())
+                ? lhs.index() < rhs.index()
+                : internal::_compare_impl<internal::_variant_less>(lhs, rhs, make_index_sequence<sizeof...(Ts)>{}));
+}
+
+template <class... Ts>
+bool operator>(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return (rhs < lhs);
+}
+
+template <class... Ts>
+bool operator<=(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return (!(rhs < lhs));
+}
+
+template <class... Ts>
+bool operator>=(const variant<Ts...>& lhs, const variant<Ts...>& rhs)
+{
+    return (!(lhs < rhs));
+}
+
+template <class... Ts>
+struct hash<variant<Ts...>>
+{
+    size_t operator()(const variant<Ts...>& value) const
+    {
+        return (internal::_hash_impl(value, make_index_sequence<sizeof...(Ts)>{}));
+    }
+};
 }
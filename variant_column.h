@@ -0,0 +1,296 @@
+#pragma once
+
+#include "variant.h"
+#include <climits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LIB_HAS_AVX2 1
+#else
+#define LIB_HAS_AVX2 0
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIB_HAS_SSE2 1
+#else
+#define LIB_HAS_SSE2 0
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace lib
+{
+namespace internal
+{
+inline unsigned int _lowest_bit(unsigned int mask) noexcept
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (static_cast<unsigned int>(index));
+#else
+    return (static_cast<unsigned int>(__builtin_ctz(mask)));
+#endif
+}
+
+inline unsigned int _popcount(unsigned int mask) noexcept
+{
+#ifdef _MSC_VER
+    mask = mask - ((mask >> 1) & 0x55555555u);
+    mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+    return ((((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#else
+    return (static_cast<unsigned int>(__builtin_popcount(mask)));
+#endif
+}
+
+template <class Func>
+void _tag_scan(const unsigned char* tags, size_t size, unsigned char tag, Func&& func)
+{
+    size_t i = 0;
+#if LIB_HAS_AVX2
+    const __m256i key32 = _mm256_set1_epi8(static_cast<char>(tag));
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+        for (auto mask = static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, key32))); mask;
+             mask &= mask - 1)
+        {
+            func(i + _lowest_bit(mask));
+        }
+    }
+#endif
+#if LIB_HAS_SSE2
+    const __m128i key16 = _mm_set1_epi8(static_cast<char>(tag));
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+        for (auto mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, key16))); mask;
+             mask &= mask - 1)
+        {
+            func(i + _lowest_bit(mask));
+        }
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        if (tags[i] == tag)
+        {
+            func(i);
+        }
+    }
+}
+
+inline size_t _tag_count(const unsigned char* tags, size_t size, unsigned char tag) noexcept
+{
+    size_t count = 0;
+    size_t i     = 0;
+#if LIB_HAS_AVX2
+    const __m256i key32 = _mm256_set1_epi8(static_cast<char>(tag));
+    for (; i + 32 <= size; i += 32)
+    {
+        const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(tags + i));
+        count += _popcount(static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, key32))));
+    }
+#endif
+#if LIB_HAS_SSE2
+    const __m128i key16 = _mm_set1_epi8(static_cast<char>(tag));
+    for (; i + 16 <= size; i += 16)
+    {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tags + i));
+        count += _popcount(static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, key16))));
+    }
+#endif
+    for (; i < size; ++i)
+    {
+        count += (tags[i] == tag);
+    }
+    return (count);
+}
+}
+
+template <class... Ts>
+class variant_column
+{
+    static_assert(sizeof...(Ts) <= UCHAR_MAX, "Too many T params.");
+    static_assert(!disjunction<is_array<Ts>...>::value, "Array cannot be used.");
+    static_assert(conjunction<is_object<Ts>...>::value, "T params must be object.");
+    static_assert(conjunction<bool_constant<internal::_type_duple_count<Ts, variant<Ts...>>::value == 1>...>::value,
+                  "T params must be unique.");
+
+public:
+    using value_type = variant<Ts...>;
+
+    template <class T>
+    using type_to_index = typename internal::_type_to_index<T, value_type>;
+
+private:
+    struct slot
+    {
+        alignas(largest<Ts...>::ALIGN) unsigned char bytes[largest<Ts...>::SIZE];
+    };
+
+    slot*          _slots    = nullptr;
+    unsigned char* _tags     = nullptr;
+    size_t         _capacity = 0;
+    size_t         _size     = 0;
+
+public:
+    // Bytes of caller storage needed for capacity elements, including slack for aligning the payload column.
+    static constexpr size_t storage_size(size_t capacity) noexcept
+    {
+        return (capacity * (sizeof(slot) + 1) + alignof(slot) - 1);
+    }
+
+    variant_column(void) noexcept = default;
+
+    variant_column(void* storage, size_t size) noexcept
+    {
+        const uintptr_t first   = reinterpret_cast<uintptr_t>(storage);
+        const uintptr_t aligned = (first + alignof(slot) - 1) & ~static_cast<uintptr_t>(alignof(slot) - 1);
+        if (!storage || aligned < first || aligned - first > size)
+        {
+            return;
+        }
+        _capacity = (size - (aligned - first)) / (sizeof(slot) + 1);
+        _slots    = reinterpret_cast<slot*>(aligned);
+        _tags     = reinterpret_cast<unsigned char*>(_slots + _capacity);
+    }
+
+    variant_column(const variant_column&) = delete;
+    variant_column& operator=(const variant_column&) = delete;
+
+    ~variant_column(void) { clear(); }
+
+    size_t size(void) const noexcept { return (_size); }
+    bool   empty(void) const noexcept { return (!_size); }
+    bool   full(void) const noexcept { return (_size == _capacity); }
+    size_t capacity(void) const noexcept { return (_capacity); }
+
+    const unsigned char* tags(void) const noexcept { return (_tags); }
+
+    size_t index(size_t pos) const noexcept { return (_tags[pos]); }
+
+    template <class T, class... Args>
+    T* emplace_back(Args&&... args)
+    {
+        if (full())
+        {
+            return (nullptr);
+        }
+        T* const value = ::new (_slots[_size].bytes) T(::lib::forward<Args>(args)...);
+        _tags[_size++] = _tag<T>();
+        return (value);
+    }
+
+    bool push_back(const value_type& value)
+    {
+        if (full() || value.index() >= sizeof...(Ts))
+        {
+            return (false);
+        }
+        visit(internal::_visit_copier{_slots[_size].bytes}, value);
+        _tags[_size++] = static_cast<unsigned char>(value.index());
+        return (true);
+    }
+
+    bool push_back(value_type&& value)
+    {
+        if (full() || value.index() >= sizeof...(Ts))
+        {
+            return (false);
+        }
+        visit(internal::_visit_mover{_slots[_size].bytes}, ::lib::move(value));
+        _tags[_size++] = static_cast<unsigned char>(value.index());
+        return (true);
+    }
+
+    void pop_back(void) noexcept
+    {
+        --_size;
+        _destroy(_size);
+    }
+
+    void clear(void) noexcept
+    {
+        if (!internal::_variant_trivial<Ts...>::value)
+        {
+            for (size_t i = 0; i < _size; ++i)
+            {
+                _destroy(i);
+            }
+        }
+        _size = 0;
+    }
+
+    template <class T>
+    T* get_if(size_t pos) noexcept
+    {
+        return ((_tags[pos] == _tag<T>()) ? _get<T>(pos) : nullptr);
+    }
+
+    template <class T>
+    const T* get_if(size_t pos) const noexcept
+    {
+        return ((_tags[pos] == _tag<T>()) ? _get<T>(pos) : nullptr);
+    }
+
+    template <class T, class Func>
+    void for_each_of(Func&& func)
+    {
+        internal::_tag_scan(_tags, _size, _tag<T>(), [this, &func](size_t pos) { func(*_get<T>(pos)); });
+    }
+
+    template <class T, class Func>
+    void for_each_of(Func&& func) const
+    {
+        internal::_tag_scan(_tags, _size, _tag<T>(), [this, &func](size_t pos) { func(*_get<T>(pos)); });
+    }
+
+    template <class T>
+    size_t count_of(void) const noexcept
+    {
+        return (internal::_tag_count(_tags, _size, _tag<T>()));
+    }
+
+    void partition_by_index(size_t* positions, size_t (&offsets)[sizeof...(Ts) + 1]) const
+    {
+        size_t count = 0;
+        for (size_t tag = 0; tag < sizeof...(Ts); ++tag)
+        {
+            offsets[tag] = count;
+            internal::_tag_scan(_tags, _size, static_cast<unsigned char>(tag),
+                                [positions, &count](size_t pos) { positions[count++] = pos; });
+        }
+        offsets[sizeof...(Ts)] = count;
+    }
+
+private:
+    template <class T>
+    static constexpr unsigned char _tag(void) noexcept
+    {
+        return (static_cast<unsigned char>(type_to_index<T>::value));
+    }
+
+    template <class T>
+    T* _get(size_t pos) noexcept
+    {
+        return (reinterpret_cast<T*>(_slots[pos].bytes));
+    }
+
+    template <class T>
+    const T* _get(size_t pos) const noexcept
+    {
+        return (reinterpret_cast<const T*>(_slots[pos].bytes));
+    }
+
+    void _destroy(size_t pos) noexcept
+    {
+        constexpr void (*vtable[])(void*) = {internal::_variant_destroy<Ts>...};
+        vtable[_tags[pos]](_slots[pos].bytes);
+    }
+};
+}
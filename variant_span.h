@@ -0,0 +1,290 @@
+#pragma once
+
+#include "type_id.h"
+#include "variant.h"
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace lib
+{
+struct variant_table_header
+{
+    static constexpr unsigned int current_version = 2;
+
+    char               magic[8];
+    unsigned int       version;
+    unsigned int       alternatives;
+    unsigned int       record_size;
+    unsigned int       record_align;
+    unsigned long long layout;
+    unsigned long long offset;
+    unsigned long long count;
+};
+
+namespace internal
+{
+constexpr char _variant_table_magic[8] = {'L', 'I', 'B', 'V', 'T', 'A', 'B', 'L'};
+
+template <class... Ts>
+constexpr unsigned long long _variant_layout(void) noexcept
+{
+    constexpr size_t    sizes[]  = {sizeof(Ts)...};
+    constexpr size_t    aligns[] = {alignof(Ts)...};
+    constexpr type_id_t ids[]    = {type_id<Ts>()...};
+    unsigned long long  hash     = 14695981039346656037ull;
+    for (size_t i = 0; i < sizeof...(Ts); ++i)
+    {
+        hash = (hash ^ sizes[i]) * 1099511628211ull;
+        hash = (hash ^ aligns[i]) * 1099511628211ull;
+        hash = (hash ^ ids[i]) * 1099511628211ull;
+    }
+    return (hash);
+}
+
+template <class Variant>
+constexpr unsigned long long _variant_table_offset(void) noexcept
+{
+    return ((sizeof(variant_table_header) + alignof(Variant) - 1) / alignof(Variant) * alignof(Variant));
+}
+}
+
+template <class... Ts>
+variant_table_header make_variant_table_header(unsigned long long count) noexcept
+{
+    using Variant = variant<Ts...>;
+    variant_table_header header{};
+    std::memcpy(header.magic, internal::_variant_table_magic, sizeof(header.magic));
+    header.version      = variant_table_header::current_version;
+    header.alternatives = sizeof...(Ts);
+    header.record_size  = sizeof(Variant);
+    header.record_align = alignof(Variant);
+    header.layout       = internal::_variant_layout<Ts...>();
+    header.offset       = internal::_variant_table_offset<Variant>();
+    header.count        = count;
+    return (header);
+}
+
+template <class... Ts>
+bool write_variant_table(std::FILE* file, const variant<Ts...>* values, size_t count)
+{
+    static_assert(conjunction<is_trivially_copyable<Ts>...>::value, "T params must be trivially copyable.");
+    const variant_table_header header  = make_variant_table_header<Ts...>(count);
+    const char                 pad[64] = {};
+    static_assert(internal::_variant_table_offset<variant<Ts...>>() - sizeof(header) <= sizeof(pad),
+                  "Padding is too large");
+    return (std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+            std::fwrite(pad, 1, header.offset - sizeof(header), file) == header.offset - sizeof(header) &&
+            std::fwrite(values, sizeof(variant<Ts...>), count, file) == count);
+}
+
+template <class... Ts>
+class variant_span
+{
+    static_assert(conjunction<is_trivially_copyable<Ts>...>::value, "T params must be trivially copyable.");
+
+public:
+    using value_type = variant<Ts...>;
+
+private:
+    const value_type* _data = nullptr;
+    size_t            _size = 0;
+
+public:
+    variant_span(void) noexcept = default;
+
+    variant_span(const void* data, size_t size) noexcept
+    {
+        const auto* const header = static_cast<const variant_table_header*>(data);
+        if (!data || size < sizeof(variant_table_header) ||
+            reinterpret_cast<uintptr_t>(data) % alignof(value_type) != 0)
+        {
+            return;
+        }
+        const variant_table_header expected = make_variant_table_header<Ts...>(0);
+        if (size < expected.offset || std::memcmp(header->magic, expected.magic, sizeof(expected.magic)) != 0 ||
+            header->version != expected.version || header->alternatives != expected.alternatives ||
+            header->record_size != expected.record_size || header->record_align != expected.record_align ||
+            header->layout != expected.layout || header->offset != expected.offset ||
+            header->count > (size - expected.offset) / sizeof(value_type))
+        {
+            return;
+        }
+        _data = reinterpret_cast<const value_type*>(static_cast<const char*>(data) + expected.offset);
+        _size = static_cast<size_t>(header->count);
+    }
+
+    explicit operator bool(void) const noexcept { return (_data); }
+
+    size_t            size(void) const noexcept { return (_size); }
+    bool              empty(void) const noexcept { return (!_size); }
+    const value_type* begin(void) const noexcept { return (_data); }
+    const value_type* end(void) const noexcept { return (_data + _size); }
+
+    // Records are not checked on construction: operator[] trusts the stored index, while at, get_if and
+    // visit reject records whose index is out of range. Call validate to check the whole table up front.
+    const value_type& operator[](size_t index) const noexcept { return (_data[index]); }
+
+    const value_type* at(size_t index) const noexcept
+    {
+        return ((index < _size && _data[index].index() < sizeof...(Ts)) ? &_data[index] : nullptr);
+    }
+
+    template <class T>
+    const T* get_if(size_t index) const noexcept
+    {
+        const value_type* const value = at(index);
+        return (value ? ::lib::get_if<T>(value) : nullptr);
+    }
+
+    template <class Visitor>
+    bool visit(size_t index, Visitor&& vis) const
+    {
+        const value_type* const value = at(index);
+        if (value)
+        {
+            ::lib::visit(::lib::forward<Visitor>(vis), *value);
+        }
+        return (value);
+    }
+
+    bool validate(void) const noexcept
+    {
+        for (size_t i = 0; i < _size; ++i)
+        {
+            if (_data[i].index() >= sizeof...(Ts))
+            {
+                return (false);
+            }
+        }
+        return (true);
+    }
+};
+
+class mapped_file
+{
+private:
+    const void* _data = nullptr;
+    size_t      _size = 0;
+#ifdef _WIN32
+    HANDLE _file    = INVALID_HANDLE_VALUE;
+    HANDLE _mapping = nullptr;
+#endif
+
+public:
+    mapped_file(void) noexcept = default;
+
+    explicit mapped_file(const char* path) noexcept
+    {
+#ifdef _WIN32
+        _file =
+            CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER size;
+        if (_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(_file, &size) || !size.QuadPart)
+        {
+            return;
+        }
+        _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping)
+        {
+            _data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+            _size = _data ? static_cast<size_t>(size.QuadPart) : 0;
+        }
+#else
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+        {
+            return;
+        }
+        struct stat status;
+        if (::fstat(fd, &status) == 0 && status.st_size > 0)
+        {
+            void* const data = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (data != MAP_FAILED)
+            {
+                _data = data;
+                _size = static_cast<size_t>(status.st_size);
+            }
+        }
+        ::close(fd);
+#endif
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& rhs) noexcept { _swap(rhs); }
+
+    mapped_file& operator=(mapped_file&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            mapped_file old{::lib::move(*this)};
+            _swap(rhs);
+        }
+        return (*this);
+    }
+
+    ~mapped_file(void)
+    {
+#ifdef _WIN32
+        if (_data)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping)
+        {
+            CloseHandle(_mapping);
+        }
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+        }
+#else
+        if (_data)
+        {
+            ::munmap(const_cast<void*>(_data), _size);
+        }
+#endif
+    }
+
+    const void* data(void) const noexcept { return (_data); }
+    size_t      size(void) const noexcept { return (_size); }
+
+    template <class... Ts>
+    variant_span<Ts...> view(void) const noexcept
+    {
+        return (variant_span<Ts...>{_data, _size});
+    }
+
+private:
+    void _swap(mapped_file& rhs) noexcept
+    {
+        const void* const data = _data;
+        const size_t      size = _size;
+        _data                  = rhs._data;
+        _size                  = rhs._size;
+        rhs._data              = data;
+        rhs._size              = size;
+#ifdef _WIN32
+        const HANDLE file    = _file;
+        const HANDLE mapping = _mapping;
+        _file                = rhs._file;
+        _mapping             = rhs._mapping;
+        rhs._file            = file;
+        rhs._mapping         = mapping;
+#endif
+    }
+};
+}